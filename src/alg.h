@@ -6,43 +6,31 @@
 #define PRINT_EVERY 1u
 
 #include "chromo.h"
+#include "coreset.h"
+#include "diversity.h"
+#include "eval.h"
+#include "metric.h"
 #include "poly.h"
+#include "pool.h"
 #include "prng.h"
+#include "rates.h"
+#include "shuffle.h"
+#include "slice.h"
+#include "solver.h"
+#include "warmstart.h"
 
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
 #include <string>
 
 namespace isai
 {
 
-  struct ga_settings_t
-  {
-    std::string batch_name = "default";
-    std::vector< double > input_coeffs;
-
-    std::size_t pop_size = 1000u;
-    std::size_t max_gens = 10000u;
-    std::size_t training_data_size = 50u;
-    std::size_t print_interval = 1u;
-    std::size_t mutation_rate_growth_threshold = 25u;
-    std::size_t pop_reset_threshold = 250u;
-
-    double error_threshold = 0.01;
-    double base_mutation_rate = 0.001;
-    double small_progress_rate_threshold = 0.01;
-    double mutation_rate_growth_coeff = 0.5;
-    double training_data_argmin = -10.0;
-    double training_data_argmax = 10.0;
-
-    bool is_input_random = true;
-    bool is_verbose = false;
-  };
-
-  template < std::size_t N >
-  using population_t = std::vector< chromosome_t< N > >;
-
   template < std::size_t N >
-  class genetic_algorithm_t
+  class genetic_algorithm_t final : public solver_t< N >
   {
   public:
     // constructor - initializes all settings, population and training data
@@ -51,6 +39,7 @@ namespace isai
       m_pop( m_settings.pop_size ),
       m_tdata(),
       m_fits( m_settings.pop_size ),
+      m_errors( m_settings.pop_size ),
       m_mutation_rate( m_settings.base_mutation_rate )
     {
       assert( m_settings.is_input_random ||
@@ -59,14 +48,265 @@ namespace isai
                     ? to_polynomial( chromosome_t< 35 >{} )
                     : polynomial_t< 4 >{ m_settings.input_coeffs.data() };
 
-      std::printf( "Initializing approximation using genetic algorithm for "
-                   "polynomial: \n        " );
-      poly.print();
-      std::printf( "        (i.e.: P(x) =" );
-      poly.print( true );
-      std::printf( ")\n" );
+      if ( !m_settings.is_quiet )
+      {
+        std::printf( "Initializing approximation using genetic algorithm for "
+                     "polynomial: \n        " );
+        poly.print();
+        std::printf( "        (i.e.: P(x) =" );
+        poly.print( true );
+        std::printf( ")\n" );
+      }
+
+      m_tdata = poly.get_training_data( m_settings.training_data_size,
+                                        m_settings.training_data_argmin,
+                                        m_settings.training_data_argmax );
+      if ( m_settings.is_error_analytic )
+      {
+        m_reference.assign( &poly[ 0 ], &poly[ 0 ] + poly.size() );
+      }
 
-      if ( m_settings.is_verbose )
+      if ( m_settings.is_file_output_enabled )
+      {
+        poly.to_file( std::string{ "data/" } + m_settings.batch_name +
+                      "_input_poly.tsv" );
+      }
+      initialize();
+    }
+
+    // constructor - initializes all settings and population, uses given
+    // training data points instead of generating them
+    genetic_algorithm_t( ga_settings_t settings, training_data_t tdata ) :
+      m_settings( std::move( settings ) ),
+      m_pop( m_settings.pop_size ),
+      m_tdata( std::move( tdata ) ),
+      m_fits( m_settings.pop_size ),
+      m_errors( m_settings.pop_size ),
+      m_mutation_rate( m_settings.base_mutation_rate )
+    {
+      assert( !m_tdata.empty() );
+      m_settings.training_data_size = m_tdata.size();
+      initialize();
+    }
+
+    // reinitializes algorithm for new problem (given settings and training
+    // data) reusing already allocated memory and current evaluator (unless
+    // new settings ask for different error metric or analytic error was
+    // used; there is no reference polynomial for given data)
+    void reset( ga_settings_t settings, training_data_t const &tdata )
+    {
+      assert( !tdata.empty() );
+      this->reset_live_state();
+      auto is_metric_changed =
+        settings.error_metric != m_settings.error_metric ||
+        settings.huber_delta != m_settings.huber_delta ||
+        !m_reference.empty();
+      m_reference.clear();
+      m_settings = std::move( settings );
+      m_settings.training_data_size = tdata.size();
+      m_tdata.assign( std::begin( tdata ), std::end( tdata ) );
+
+      m_pop.resize( m_settings.pop_size );
+      for ( auto &&ch : m_pop )
+      {
+        ch = chromosome_t< N >{};
+      }
+      seed_population( m_pop, m_tdata, m_settings.warm_start_fraction );
+      update_thread_pool();
+      reduce_training_data();
+      m_fits.assign( m_settings.pop_size, 0.0 );
+      m_errors.assign( m_settings.pop_size, 0.0 );
+
+      m_curr_gen = 1u;
+      m_best_repeats = 0u;
+      m_eval_count = 0u;
+      m_mutation_rate = m_settings.base_mutation_rate;
+      m_error = 0.0;
+      m_avg_error = 0.0;
+      m_diversity = 1.0;
+      m_error_accum = 0.0;
+      m_avg_error_accum = 0.0;
+      m_is_started = false;
+      m_is_bred = false;
+      m_rate_weights.reset();
+      if ( m_progress_out.is_open() )
+      {
+        m_progress_out.close();
+      }
+
+      if ( is_metric_changed )
+      {
+        set_evaluator( make_local_evaluator< N >( m_settings.error_metric,
+                                                  m_settings.huber_delta ) );
+      }
+      else
+      {
+        m_evaluator->bind( m_tdata );
+      }
+    }
+
+    // runs whole training process
+    void run() override
+    {
+      while ( step() )
+      {
+      }
+
+      print_completion_info();
+    }
+
+    // runs single generation of training process (first call evaluates
+    // initial population); returns false once stopping criteria are met
+    bool step() override
+    {
+      if ( !m_is_started )
+      {
+        evaluate_population();
+        complete_generation();
+      }
+
+      if ( !prepare_generation() )
+      {
+        return false;
+      }
+
+      evaluate_population();
+      complete_generation();
+
+      return !check_completion_condition();
+    }
+
+    // first phase of generation for engines evaluating population externally
+    // (e.g. many populations at once) - creates next generation awaiting
+    // evaluation (initial population if not started yet); returns false if
+    // stopping criteria are already met
+    bool prepare_generation()
+    {
+      if ( !m_is_started )
+      {
+        return true;
+      }
+
+      if ( check_completion_condition() )
+      {
+        return false;
+      }
+
+      reproduce();
+      update_gene_rates();
+      if ( m_settings.is_population_bit_sliced )
+      {
+        breed_sliced();
+      }
+      else
+      {
+        crossover();
+        mutate();
+      }
+      return true;
+    }
+
+    // second phase of externally evaluated generation - takes errors of
+    // members of population() prepared in first phase
+    void complete_generation( std::vector< double > const &errors )
+    {
+      assert( errors.size() == m_pop.size() );
+      m_errors = errors;
+      m_eval_count += m_pop.size();
+      complete_generation();
+    }
+
+    // current population
+    population_t< N > const &population() const noexcept { return m_pop; }
+
+    // settings of algorithm
+    ga_settings_t const &settings() const noexcept override
+    {
+      return m_settings;
+    }
+
+    // training data that population is evaluated against
+    training_data_t const &training_data() const noexcept override
+    {
+      return m_tdata;
+    }
+
+    // training data given to algorithm (differs from training_data() only
+    // while population is evaluated on its coreset)
+    training_data_t const &full_training_data() const noexcept
+    {
+      return m_full_tdata.empty() ? m_tdata : m_full_tdata;
+    }
+
+    // replaces component used for computing errors of population members
+    // (binds training data to it)
+    void set_evaluator(
+      std::shared_ptr< fitness_evaluator_t< N > > evaluator ) override
+    {
+      assert( evaluator );
+      evaluator->bind( m_tdata );
+      m_evaluator = std::move( evaluator );
+    }
+
+    // puts given chromosomes into initial population in place of its last
+    // members
+    void seed( population_t< N > const &seeds ) override
+    {
+      assert( !m_is_started );
+      auto count = std::min( seeds.size(), m_pop.size() );
+      std::copy( std::begin( seeds ), std::begin( seeds ) + count,
+                 std::end( m_pop ) - count );
+    }
+
+    // returns polynomial representing member of final population with best
+    // fitness (least approx error)
+    typename solver_t< N >::result_t result() const override
+    {
+      auto best = index_of_best_individual();
+      auto res = to_polynomial( m_pop[ best ] );
+      if ( m_settings.is_file_output_enabled )
+      {
+        res.to_file( std::string{ "data/" } + m_settings.batch_name +
+                     "_output_poly.tsv" );
+      }
+      auto err =
+        is_coreset_used() ? full_error( m_pop[ best ] ) : m_errors[ best ];
+      return std::make_pair( res, err );
+    }
+
+    // returns polynomial represented by current best population member
+    auto best_polynomial() const { return to_polynomial( best_individual() ); }
+
+    // true if population is evaluated on coreset of training data
+    bool is_coreset_used() const noexcept { return !m_full_tdata.empty(); }
+
+    // progress queries
+    std::size_t generation() const noexcept override { return m_curr_gen; }
+    std::size_t evaluation_count() const noexcept override
+    {
+      return m_eval_count;
+    }
+    double best_error() const noexcept override { return m_error; }
+    double avg_error() const noexcept { return m_avg_error; }
+    double mutation_rate() const noexcept { return m_mutation_rate; }
+    double diversity() const noexcept { return m_diversity; }
+    bool is_done() const override
+    {
+      return m_is_started && check_completion_condition();
+    }
+
+  private:
+    /*-----------------------*/
+    /*     HELPER METHODS    */
+    /*-----------------------*/
+
+    // common part of constructors - reports settings, saves training data,
+    // seeds population with least-squares fit and sets up default evaluator
+    // (analytic one if reference polynomial is known and settings ask for
+    // it, otherwise local one working on training data or its coreset)
+    void initialize()
+    {
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
       {
         std::printf( "Main model parameters:\n" );
         std::printf( " - population size:                %5lu\n",
@@ -81,62 +321,155 @@ namespace isai
                      m_settings.error_threshold );
       }
 
-      m_tdata = poly.get_training_data( m_settings.training_data_size,
-                                        m_settings.training_data_argmin,
-                                        m_settings.training_data_argmax );
+      seed_population( m_pop, m_tdata, m_settings.warm_start_fraction );
+      update_thread_pool();
 
-      // save init data to files
-      poly.to_file( std::string{ "data/" } + m_settings.batch_name +
-                    "_input_poly.tsv" );
-      training_data_to_file( std::string{ "data/" } + m_settings.batch_name +
-                             "_training_data.tsv" );
+      if ( m_settings.is_file_output_enabled )
+      {
+        training_data_to_file( std::string{ "data/" } +
+                               m_settings.batch_name + "_training_data.tsv" );
+      }
+
+      if ( !m_reference.empty() )
+      {
+        set_evaluator( std::make_shared< interval_l2_evaluator_t< N > >(
+          m_reference, m_settings.training_data_argmin,
+          m_settings.training_data_argmax ) );
+        return;
+      }
+
+      reduce_training_data();
+      set_evaluator( make_local_evaluator< N >( m_settings.error_metric,
+                                                m_settings.huber_delta ) );
     }
 
-    // runs whole training process
-    void run()
+    // replaces training data with its weighted coreset if settings ask for
+    // it (full data is kept for confirming final answer); linf metric is
+    // never reduced, as no sample preserves maximal error
+    void reduce_training_data()
     {
-      auto progress_file_path =
-        std::string{ "data/" } + m_settings.batch_name + "_progress_data.tsv";
-      auto fout =
-        std::ofstream{ progress_file_path, std::ios::out | std::ios::trunc };
+      m_full_tdata.clear();
+      auto size = std::max( m_settings.coreset_size,
+                            coreset_size_for_error(
+                              m_settings.coreset_error_bound, N / 7u ) );
+      if ( size == 0u || size >= m_tdata.size() ||
+           m_settings.error_metric == metric_kind_t::linf )
+      {
+        return;
+      }
 
-      m_error = 2.0 * m_settings.error_threshold;
-      calculate_fitness_scores_and_error_metrics();
+      auto coreset = training_data_t{};
+      if ( !build_coreset( m_tdata, N / 7u, size, coreset ) )
+      {
+        return;
+      }
+      m_full_data.assign( m_tdata );
+      m_full_tdata.swap( m_tdata );
+      m_tdata.swap( coreset );
 
-      while ( !check_completion_condition() )
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
       {
-        auto temp_pop = reproduce();
-        m_pop = std::move( crossover( temp_pop ) );
-        mutate();
-        calculate_fitness_scores_and_error_metrics();
-        adjust_mutation_rate();
+        std::printf( "Population is evaluated on coreset of %lu training "
+                     "data points.\n",
+                     m_tdata.size() );
+      }
+    }
 
-        // info dump
-        print_progress();
-        progress_to_file( fout );
+    // error of given chromosome with respect to full training data
+    double full_error( chromosome_t< N > const &chromo ) const
+    {
+      return dispatch_metric(
+        m_settings.error_metric, m_settings.huber_delta,
+        [this, &chromo]( auto metric ) {
+          return eval_error( chromo, m_full_data, metric );
+        } );
+    }
 
-        // increase generation counter
-        m_curr_gen++;
+    // checks best population member (that meets error threshold on coreset)
+    // against full training data and returns its full error - if it fails
+    // there, coreset is dropped and algorithm continues on full data
+    double confirm_on_full_data()
+    {
+      auto best = index_of_best_individual();
+      auto err = full_error( m_pop[ best ] );
+      m_eval_count++;
+      m_errors[ best ] = err;
+      if ( err > m_settings.error_threshold )
+      {
+        if ( m_settings.is_verbose && !m_settings.is_quiet )
+        {
+          std::printf( "Solution found on coreset has error %.4f on full "
+                       "training data - dropping coreset.\n",
+                       err );
+        }
+        m_tdata.swap( m_full_tdata );
+        m_full_tdata.clear();
+        m_evaluator->bind( m_tdata );
       }
+      return err;
+    }
 
-      print_completion_info();
+    // computes errors of current population using evaluator
+    void evaluate_population()
+    {
+      m_evaluator->evaluate( m_pop, m_errors );
+      m_eval_count += m_pop.size();
     }
 
-    // returns polynomial representing member of final population with best
-    // fitness (least approx error)
-    auto result() const
+    // updates algorithm state after population got evaluated - either
+    // initializes it for first generation (also opens progress file) or
+    // finishes next one
+    void complete_generation()
     {
-      auto res_ch = best_individual();
-      auto res = to_polynomial( res_ch );
-      res.to_file( std::string{ "data/" } + m_settings.batch_name +
-                   "_output_poly.tsv" );
-      return std::make_pair( res, eval_error( res_ch, m_tdata ) );
+      if ( !m_is_started )
+      {
+        if ( m_settings.is_file_output_enabled )
+        {
+          m_progress_out.open( std::string{ "data/" } +
+                                 m_settings.batch_name + "_progress_data.tsv",
+                               std::ios::out | std::ios::trunc );
+        }
+
+        m_error = 2.0 * m_settings.error_threshold;
+        update_fitness_scores();
+        update_diversity();
+        m_is_started = true;
+        publish_state();
+        return;
+      }
+
+      update_fitness_scores();
+      update_diversity();
+      if ( m_is_bred )
+      {
+        credit_mutations();
+      }
+      adjust_mutation_rate();
+
+      // info dump
+      print_progress();
+      if ( m_progress_out.is_open() )
+      {
+        progress_to_file( m_progress_out );
+      }
+
+      // increase generation counter
+      m_curr_gen++;
+      publish_state();
     }
 
-  private:
-    /*-----------------------*/
-    /*     HELPER METHODS    */
-    /*-----------------------*/
+    // publishes current state for snapshot readers
+    void publish_state() noexcept
+    {
+      auto snap = solver_snapshot_t{};
+      snap.generation = m_curr_gen;
+      snap.evaluation_count = m_eval_count;
+      snap.best_error = m_error;
+      snap.avg_error = m_avg_error;
+      snap.mutation_rate = m_mutation_rate;
+      snap.is_done = check_completion_condition();
+      this->publish( to_polynomial( best_individual() ), snap );
+    }
 
     // returns index of population member with best fitness score
     std::size_t index_of_best_individual() const
@@ -158,31 +491,40 @@ namespace isai
       return m_pop[ index_of_best_individual() ];
     }
 
-    // checks if given stopping criteria are met
-    bool check_completion_condition()
+    // checks if given stopping criteria are met (or algorithm is
+    // cancelled)
+    bool check_completion_condition() const
     {
       return m_curr_gen >= m_settings.max_gens ||
-             m_error <= m_settings.error_threshold;
+             m_error <= m_settings.error_threshold || this->is_cancelled();
     }
 
     /*------------------------*/
     /*     ALGORITHM STEPS    */
     /*------------------------*/
 
-    // updates fitness scores for population
-    // fitness is given by inverse of average linear error with respect to given
-    // data fitness is normalized so that sum of all scores is equal to 2 * pop
-    // size also updates data on current error of training data approximation
+    // evaluates population and updates its fitness scores
     void calculate_fitness_scores_and_error_metrics()
+    {
+      evaluate_population();
+      update_fitness_scores();
+    }
+
+    // updates fitness scores for population from its errors
+    // fitness is given by inverse of error (in chosen metric) with respect to
+    // given data fitness is normalized so that sum of all scores is equal to
+    // 2 * pop size also updates data on current error of training data
+    // approximation
+    void update_fitness_scores()
     {
       // calculate base fitness score: 1 / err (or big number if err == 0)
       auto index = std::size_t{ 0 };
       auto total = double{ 0.0 };
       m_avg_error = 0.0;
 
-      for ( auto &&ch : m_pop )
+      for ( auto &&err : m_errors )
       {
-        auto fit = eval_error( ch, m_tdata );
+        auto fit = err;
         if ( fit != 0.0 )
         {
           m_avg_error += fit;
@@ -207,7 +549,11 @@ namespace isai
       }
 
       // update error of population's best member
-      auto err_of_best = eval_error( best_individual(), m_tdata );
+      auto err_of_best = m_errors[ index_of_best_individual() ];
+      if ( is_coreset_used() && err_of_best <= m_settings.error_threshold )
+      {
+        err_of_best = confirm_on_full_data();
+      }
 
       // check if that error changed enougn - if not increment repeat counter
       auto diff = std::abs( err_of_best - m_error );
@@ -218,12 +564,13 @@ namespace isai
       m_error = err_of_best;
     }
 
-    // creates double population by reproducing current individuals
-    // proportionally to their fitness assumes proper fitness values are already
-    // calculated
-    population_t< N > reproduce()
+    // selects double population of parents by reproducing current
+    // individuals proportionally to their fitness (only their indices are
+    // stored) assumes proper fitness values are already calculated
+    void reproduce()
     {
-      auto res = population_t< N >{};
+      auto &res = m_parent_ids;
+      res.clear();
       res.reserve( m_pop.size() * 2u );
 
       // create reproduced individuals in proportional numbers to fitness
@@ -234,7 +581,7 @@ namespace isai
         for ( auto i = std::size_t{ 0 };
               i < static_cast< std::size_t >( children_count ); i++ )
         {
-          res.emplace_back( m_pop[ index ] );
+          res.push_back( static_cast< std::uint32_t >( index ) );
         }
         index++;
         fit -= children_count;
@@ -255,35 +602,156 @@ namespace isai
 
       for ( auto i = std::size_t{ 0 }; i < rem; i++ )
       {
-        res.emplace_back( m_pop[ prng_t::pick_by_prob( m_fits ) ] );
+        res.push_back(
+          static_cast< std::uint32_t >( prng_t::pick_by_prob( m_fits ) ) );
       }
 
       assert( res.size() == m_pop.size() * 2u );
+    }
 
-      return res;
+    // creates new population from reproduced ones using crossover - random
+    // pairing is obtained by permuting parent indices, chromosomes are only
+    // gathered from current population
+    void crossover()
+    {
+      auto &ids = m_parent_ids;
+      m_shuffler.shuffle( ids, m_pool.get() );
+      record_baselines();
+
+      auto &res = m_next;
+      res.resize( m_pop.size() );
+      assert( ids.size() == res.size() * 2u );
+
+      for_each_chunk(
+        m_pool.get(), res.size(), CHUNK_SIZE,
+        [this, &ids, &res]( std::size_t begin, std::size_t end ) {
+          for ( auto i = begin; i < end; i++ )
+          {
+            res[ i ] = m_pop[ ids[ 2u * i ] ].crossover(
+              m_pop[ ids[ 2u * i + 1u ] ] );
+          }
+        } );
+      std::swap( m_pop, res );
     }
 
-    // creates new population from reproduced ones using crossover
-    auto crossover( population_t< N > &parents )
+    // applies mutations to population at rates of genes (skip sampled)
+    void mutate()
     {
-      prng_t::shuffle( parents );
-      auto res = population_t< N >{};
-      res.reserve( m_pop.size() );
+      auto flips_p = m_settings.is_gene_rate_adaptive ? m_flips.data()
+                                                      : nullptr;
+      for_each_chunk( m_pool.get(), m_pop.size(), CHUNK_SIZE,
+                      [this, flips_p]( std::size_t begin, std::size_t end ) {
+                        mutate_skip_sampled( m_pop, begin, end, m_gene_rates,
+                                             flips_p );
+                      } );
+    }
 
-      for ( auto i = std::size_t{ 0 }; i < parents.size(); i += 2 )
+    // computes mutation rates of genes for this generation - global one
+    // scaled by adapted weights of genes (if enabled); weights are not used
+    // while mutation rate grows (stagnation calls for exploration of all
+    // genes, but their credits are still collected)
+    void update_gene_rates()
+    {
+      if ( m_settings.is_gene_rate_adaptive )
       {
-        res.emplace_back( parents[ i ].crossover( parents[ i + 1 ] ) );
+        m_flips.resize( m_pop.size() );
+        m_baselines.resize( m_pop.size() );
+      }
+      if ( m_settings.is_gene_rate_adaptive &&
+           m_best_repeats < m_settings.mutation_rate_growth_threshold )
+      {
+        m_rate_weights.rates( m_mutation_rate, m_gene_rates );
+      }
+      else
+      {
+        m_gene_rates.fill( m_mutation_rate );
       }
-      assert( m_pop.size() == res.size() );
-      return res;
     }
 
-    // applies mutations to population at given rate
-    void mutate()
+    // stores error of better parent of every child (shuffled parent ids
+    // are paired as by crossover) for crediting mutations
+    void record_baselines()
     {
-      for ( auto &&ch : m_pop )
+      if ( !m_settings.is_gene_rate_adaptive )
+      {
+        return;
+      }
+      auto &ids = m_parent_ids;
+      for ( auto i = std::size_t{ 0 }; i < m_baselines.size(); i++ )
+      {
+        m_baselines[ i ] = std::min( m_errors[ ids[ 2u * i ] ],
+                                     m_errors[ ids[ 2u * i + 1u ] ] );
+      }
+      m_is_bred = true;
+    }
+
+    // credits genes flipped in children that got better than their better
+    // parents (success rate rather than size of improvement - large gains
+    // of rare high order flips would otherwise dominate), adapts weights of
+    // gene rates
+    void credit_mutations()
+    {
+      for ( auto i = std::size_t{ 0 }; i < m_flips.size(); i++ )
+      {
+        if ( m_flips[ i ] != 0u )
+        {
+          m_rate_weights.credit( m_flips[ i ],
+                                 m_errors[ i ] < m_baselines[ i ] ? 1.0 : 0.0 );
+        }
+      }
+      m_rate_weights.update();
+      m_is_bred = false;
+    }
+
+    // creates new population from reproduced ones in bit-sliced layout -
+    // same pairing as crossover, but children are bred in blocks of 64
+    // (crossover and mutation done by masks over whole slices) and then
+    // transposed back to chromosomes
+    void breed_sliced()
+    {
+      auto &ids = m_parent_ids;
+      m_shuffler.shuffle( ids, m_pool.get() );
+      record_baselines();
+
+      m_next.resize( m_pop.size() );
+      m_sliced.resize( m_pop.size() );
+      assert( ids.size() == m_next.size() * 2u );
+
+      auto thresholds = std::array< std::uint64_t, N >{};
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
       {
-        ch.mutate( m_mutation_rate );
+        thresholds[ g ] = mask_threshold( m_gene_rates[ g ] );
+      }
+      auto flips_p = m_settings.is_gene_rate_adaptive ? m_flips.data()
+                                                      : nullptr;
+      for_each_chunk(
+        m_pool.get(), m_sliced.block_count(), CHUNK_SIZE / SLICE_LANES,
+        [this, &ids, &thresholds, flips_p]( std::size_t begin,
+                                            std::size_t end ) {
+          for ( auto b = begin; b < end; b++ )
+          {
+            m_sliced.breed( b, m_pop, ids.data(), thresholds.data(),
+                            flips_p );
+            m_sliced.store( b, m_next );
+          }
+        } );
+      std::swap( m_pop, m_next );
+    }
+
+    // starts pool of helper threads as requested by settings (calling thread
+    // is used too, so thread count of 1 means no pool)
+    void update_thread_pool()
+    {
+      auto count = m_settings.thread_count != 0u
+                     ? m_settings.thread_count
+                     : std::max( 1u, std::thread::hardware_concurrency() );
+      if ( count < 2u )
+      {
+        m_pool.reset();
+      }
+      else if ( !m_pool || m_pool->thread_count() != count - 1u )
+      {
+        m_pool = std::make_unique< thread_pool_t >( count - 1u );
       }
     }
 
@@ -296,21 +764,12 @@ namespace isai
         m_mutation_rate = m_settings.base_mutation_rate;
       }
 
-      //  large number of repeats - reset population
-      else if ( m_best_repeats >= m_settings.pop_reset_threshold )
+      //  large number of repeats or stalled population that lost its
+      //  diversity - restart population
+      else if ( m_best_repeats >= m_settings.pop_reset_threshold ||
+                m_diversity < m_settings.diversity_collapse_threshold )
       {
-        if ( m_settings.is_verbose )
-        {
-          std::printf( "Resetting population (no significant change in best "
-                       "result after %lu generations).\n",
-                       m_best_repeats );
-        }
-
-        m_pop = population_t< N >( m_pop.size() );
-        m_fits = std::vector< double >( m_pop.size() );
-        m_mutation_rate = m_settings.base_mutation_rate;
-        m_best_repeats = 0u;
-        calculate_fitness_scores_and_error_metrics();
+        restart_population();
       }
 
       // moderate number of repeats - increase mutation rate linearly
@@ -327,6 +786,63 @@ namespace isai
       }
     }
 
+    // replaces stagnated population - either whole (full policy) or given
+    // fraction of its worst members (partial policy, best ones are kept)
+    void restart_population()
+    {
+      if ( m_settings.is_verbose )
+      {
+        std::printf( "%s population (no significant change in best result "
+                     "after %lu generations, diversity: %.4f).\n",
+                     m_settings.restart_policy == restart_policy_t::full
+                       ? "Resetting"
+                       : "Reseeding",
+                     m_best_repeats, m_diversity );
+      }
+
+      if ( m_settings.restart_policy == restart_policy_t::full )
+      {
+        m_pop = population_t< N >( m_pop.size() );
+      }
+      else
+      {
+        auto order = std::vector< std::size_t >( m_pop.size() );
+        std::iota( std::begin( order ), std::end( order ), std::size_t{ 0 } );
+        std::sort( std::begin( order ), std::end( order ),
+                   [this]( std::size_t lhs, std::size_t rhs ) {
+                     return m_errors[ lhs ] < m_errors[ rhs ];
+                   } );
+
+        auto kept = std::min( m_settings.restart_elite_count, m_pop.size() );
+        auto reseeded = std::min(
+          static_cast< std::size_t >( std::round(
+            m_settings.restart_reseed_fraction *
+            static_cast< double >( m_pop.size() ) ) ),
+          m_pop.size() - kept );
+
+        for ( auto i = m_pop.size() - reseeded; i < m_pop.size(); i++ )
+        {
+          m_pop[ order[ i ] ] = chromosome_t< N >{};
+        }
+      }
+
+      m_fits = std::vector< double >( m_pop.size() );
+      m_mutation_rate = m_settings.base_mutation_rate;
+      m_best_repeats = 0u;
+      calculate_fitness_scores_and_error_metrics();
+      update_diversity();
+    }
+
+    // updates (estimated) diversity of population
+    void update_diversity()
+    {
+      if ( m_settings.diversity_sample_size > 0 )
+      {
+        m_diversity =
+          estimate_diversity( m_pop, m_settings.diversity_sample_size );
+      }
+    }
+
 
     /*--------------------------*/
     /*    INFORMATION OUTPUT    */
@@ -354,11 +870,11 @@ namespace isai
         {
 
           std::printf( "GEN# %04lu -   avg_err: %10.3f,   best_err: %10.3f,   "
-                       "reps: %7lu,   mut: %7.4f;\n",
+                       "reps: %7lu,   mut: %7.4f,   div: %6.4f;\n",
                        m_curr_gen,
                        m_avg_error_accum / m_settings.print_interval,
                        m_error_accum / m_settings.print_interval,
-                       m_best_repeats, m_mutation_rate );
+                       m_best_repeats, m_mutation_rate, m_diversity );
 
           m_error_accum = 0.0;
           m_avg_error_accum = 0.0;
@@ -376,12 +892,22 @@ namespace isai
     // prints to stdout info abot final state
     void print_completion_info()
     {
+      if ( m_settings.is_quiet )
+      {
+        return;
+      }
+
       if ( m_settings.is_verbose )
       {
         std::printf( "\n" );
       }
 
-      if ( m_curr_gen == m_settings.max_gens )
+      if ( m_error > m_settings.error_threshold && this->is_cancelled() )
+      {
+        std::printf( "Training cancelled after %lu generations.\n",
+                     m_curr_gen - 1 );
+      }
+      else if ( m_curr_gen == m_settings.max_gens )
       {
         std::printf(
           "Training ended after reaching maximal number of generations allowed "
@@ -425,20 +951,44 @@ namespace isai
   private:
     ga_settings_t m_settings;
 
+    // number of chromosomes processed by single parallel task
+    static constexpr const std::size_t CHUNK_SIZE = 256u;
+
     population_t< N > m_pop;
+    population_t< N > m_next;
+    sliced_population_t< N > m_sliced;  // children (bit-sliced breeding)
+    gene_rates_t< N > m_rate_weights;
+    std::array< double, N > m_gene_rates;  // mutation rates of generation
+    std::vector< std::uint64_t > m_flips;  // genes mutated in children
+    std::vector< double > m_baselines;  // errors of better parents
+    std::vector< std::uint32_t > m_parent_ids;
+    scatter_shuffler_t< std::uint32_t > m_shuffler;
+    std::unique_ptr< thread_pool_t > m_pool;
     training_data_t m_tdata;
+    training_data_t m_full_tdata;  // empty unless m_tdata is its coreset
+    std::vector< double > m_reference;  // known input (for analytic error)
+    metric_data_t m_full_data;
     std::vector< double > m_fits;
+    std::vector< double > m_errors;
+
+    std::shared_ptr< fitness_evaluator_t< N > > m_evaluator;
+    std::ofstream m_progress_out;
 
     std::size_t m_curr_gen = 1u;
     std::size_t m_best_repeats = 0u;
+    std::size_t m_eval_count = 0u;
 
     double m_mutation_rate;
 
     double m_error = 0.0;
     double m_avg_error = 0.0;
+    double m_diversity = 1.0;
 
     double m_error_accum = 0.0;
     double m_avg_error_accum = 0.0;
+
+    bool m_is_started = false;
+    bool m_is_bred = false;  // children await crediting of mutations
   };
 
 }  // namespace isai
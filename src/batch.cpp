@@ -0,0 +1 @@
+#include "batch.h"
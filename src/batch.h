@@ -0,0 +1,247 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_BATCH_H_INCLUDED
+#define ISAI_GENEPI_BATCH_H_INCLUDED
+
+#include "alg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace isai
+{
+
+  // engine evolving populations of many independent problems side by side
+  // every problem is driven by its own genetic algorithm (with its own
+  // convergence check), but populations of all still active problems are
+  // evaluated together by one kernel working on problem-major layout (value
+  // for problem p is stored at [ ... * P + p ]), so that its innermost loop
+  // runs across problems and gets vectorized; finished problems drop out of
+  // the layout while remaining ones keep running; errors are computed using
+  // given metric policy
+  template < std::size_t N, typename Metric = l1_metric_t >
+  class batched_genetic_algorithm_t
+  {
+    // number of polynomial coefficients encoded by chromosome
+    static constexpr const std::size_t K = N / 7u;
+
+    // number of problems processed together by kernel (number of problem
+    // slots is padded to its multiple, so that fixed-width lane loops are
+    // vectorized even without cost model allowing scalar epilogues)
+    static constexpr const std::size_t LANES = 4u;
+
+  public:
+    // constructor - creates algorithm for each given training data set
+    // (settings are shared, console and file output is disabled, every
+    // algorithm runs in calling thread and uses full training data - kernel
+    // lays out data of all problems once)
+    batched_genetic_algorithm_t( ga_settings_t settings,
+                                 std::vector< training_data_t > problems,
+                                 Metric metric = Metric{} ) :
+      m_metric( metric )
+    {
+      settings.thread_count = 1u;
+      settings.is_verbose = false;
+      settings.is_quiet = true;
+      settings.is_file_output_enabled = false;
+      settings.coreset_size = 0u;
+      settings.coreset_error_bound = 0.0;
+
+      m_gas.reserve( problems.size() );
+      for ( auto &&td : problems )
+      {
+        m_gas.emplace_back( settings, std::move( td ) );
+      }
+
+      m_active.resize( m_gas.size() );
+      std::iota( std::begin( m_active ), std::end( m_active ),
+                 std::size_t{ 0 } );
+      m_errors.resize( m_gas.size() );
+      rebuild_layout();
+    }
+
+    // runs all problems until each of them meets its stopping criteria
+    void run()
+    {
+      while ( step() )
+      {
+      }
+    }
+
+    // runs single generation of all active problems; returns false when no
+    // problem is left running
+    bool step()
+    {
+      // let algorithms prepare next generation, drop finished ones
+      auto active_count = m_active.size();
+      m_active.erase( std::remove_if( std::begin( m_active ),
+                                      std::end( m_active ),
+                                      [this]( std::size_t p ) {
+                                        return !m_gas[ p ].prepare_generation();
+                                      } ),
+                      std::end( m_active ) );
+
+      if ( m_active.empty() )
+      {
+        return false;
+      }
+      if ( m_active.size() != active_count )
+      {
+        rebuild_layout();
+      }
+
+      evaluate_active();
+
+      for ( auto &&p : m_active )
+      {
+        m_gas[ p ].complete_generation( m_errors[ p ] );
+      }
+      return true;
+    }
+
+    // number of all problems
+    std::size_t problem_count() const noexcept { return m_gas.size(); }
+
+    // number of problems that are still running
+    std::size_t active_count() const noexcept { return m_active.size(); }
+
+    // algorithm solving given problem
+    genetic_algorithm_t< N > const &problem( std::size_t index ) const
+    {
+      assert( index < m_gas.size() );
+      return m_gas[ index ];
+    }
+
+    // best polynomial found for given problem and its error
+    auto result( std::size_t index ) const
+    {
+      assert( index < m_gas.size() );
+      return m_gas[ index ].result();
+    }
+
+  private:
+    // recreates problem-major copy of training data of active problems
+    // (shorter data sets are padded with zero-weight points)
+    void rebuild_layout()
+    {
+      auto pc = ( ( m_active.size() + LANES - 1u ) / LANES ) * LANES;
+      m_slot_count = pc;
+      m_point_count = 0u;
+      for ( auto &&p : m_active )
+      {
+        m_point_count =
+          std::max( m_point_count, m_gas[ p ].training_data().size() );
+      }
+
+      m_xs.assign( m_point_count * pc, 0.0 );
+      m_ys.assign( m_point_count * pc, 0.0 );
+      m_ws.assign( m_point_count * pc, 0.0 );
+      m_weight_sums.assign( pc, 0.0 );
+
+      for ( auto slot = std::size_t{ 0 }; slot < m_active.size(); slot++ )
+      {
+        auto const &td = m_gas[ m_active[ slot ] ].training_data();
+        for ( auto j = std::size_t{ 0 }; j < td.size(); j++ )
+        {
+          m_xs[ j * pc + slot ] = td[ j ].x;
+          m_ys[ j * pc + slot ] = td[ j ].y;
+          m_ws[ j * pc + slot ] = td[ j ].w;
+          m_weight_sums[ slot ] += td[ j ].w;
+        }
+      }
+    }
+
+    // decodes populations of all active problems into problem-major
+    // coefficient block and computes their errors
+    void evaluate_active()
+    {
+      auto pc = m_slot_count;
+      auto pop_size = m_gas[ m_active.front() ].population().size();
+
+      // coefficient k of individual i for problem in slot s is stored at
+      // [ ( i * K + k ) * pc + s ] (padding slots stay zero)
+      m_coeffs.assign( pop_size * K * pc, 0.0 );
+      for ( auto slot = std::size_t{ 0 }; slot < m_active.size(); slot++ )
+      {
+        auto const &pop = m_gas[ m_active[ slot ] ].population();
+        for ( auto i = std::size_t{ 0 }; i < pop_size; i++ )
+        {
+          auto poly = to_polynomial( pop[ i ] );
+          for ( auto k = std::size_t{ 0 }; k < K; k++ )
+          {
+            m_coeffs[ ( i * K + k ) * pc + slot ] = poly[ k ];
+          }
+        }
+      }
+
+      for ( auto &&p : m_active )
+      {
+        m_errors[ p ].resize( pop_size );
+      }
+
+      m_acc.resize( pc );
+      for ( auto i = std::size_t{ 0 }; i < pop_size; i++ )
+      {
+        auto c_p = m_coeffs.data() + i * K * pc;
+        std::fill( std::begin( m_acc ), std::end( m_acc ), 0.0 );
+
+        for ( auto j = std::size_t{ 0 }; j < m_point_count; j++ )
+        {
+          auto x_p = m_xs.data() + j * pc;
+          auto y_p = m_ys.data() + j * pc;
+          auto w_p = m_ws.data() + j * pc;
+
+          // innermost loops run across problems
+          for ( auto s = std::size_t{ 0 }; s < pc; s += LANES )
+          {
+            double vals[ LANES ];
+            for ( auto l = std::size_t{ 0 }; l < LANES; l++ )
+            {
+              vals[ l ] = c_p[ ( K - 1u ) * pc + s + l ];
+            }
+            for ( auto k = K - 1u; k > 0; k-- )
+            {
+              auto ck_p = c_p + ( k - 1u ) * pc + s;
+              for ( auto l = std::size_t{ 0 }; l < LANES; l++ )
+              {
+                vals[ l ] = vals[ l ] * x_p[ s + l ] + ck_p[ l ];
+              }
+            }
+            for ( auto l = std::size_t{ 0 }; l < LANES; l++ )
+            {
+              m_acc[ s + l ] = m_metric.accumulate(
+                m_acc[ s + l ], y_p[ s + l ] - vals[ l ], w_p[ s + l ] );
+            }
+          }
+        }
+
+        for ( auto s = std::size_t{ 0 }; s < m_active.size(); s++ )
+        {
+          m_errors[ m_active[ s ] ][ i ] =
+            m_metric.finish( m_acc[ s ], m_weight_sums[ s ] );
+        }
+      }
+    }
+
+  private:
+    Metric m_metric;
+    std::vector< genetic_algorithm_t< N > > m_gas;
+    std::vector< std::size_t > m_active;
+    std::vector< std::vector< double > > m_errors;
+
+    std::size_t m_point_count = 0u;
+    std::size_t m_slot_count = 0u;
+    std::vector< double > m_xs;
+    std::vector< double > m_ys;
+    std::vector< double > m_ws;
+    std::vector< double > m_weight_sums;
+
+    std::vector< double > m_coeffs;
+    std::vector< double > m_acc;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_BATCH_H_INCLUDED
@@ -0,0 +1,39 @@
+#include "bench.h"
+
+#include "chromo.h"
+#include "prng.h"
+
+namespace isai
+{
+
+  polynomial_t< 4 > bench_target( std::size_t k )
+  {
+    prng_t::seed( 0x5eed0000u + k );
+    return to_polynomial( chromosome_t< 35 >{} );
+  }
+
+  training_data_t bench_training_data( polynomial_t< 4 > target,
+                                       ga_settings_t const &settings )
+  {
+    auto res = target.get_training_data( settings.training_data_size,
+                                         settings.training_data_argmin,
+                                         settings.training_data_argmax );
+    auto amplitude = BENCH_NOISE_AMPLITUDE * settings.error_threshold;
+    for ( auto &&dp : res )
+    {
+      dp.y += amplitude * ( 2.0 * prng_t::get_fraction() - 1.0 );
+    }
+    return res;
+  }
+
+  ga_settings_t bench_settings( ga_settings_t settings )
+  {
+    settings.warm_start_fraction = 0.0;
+    settings.solution_cache_path.clear();
+    settings.is_verbose = false;
+    settings.is_quiet = true;
+    settings.is_file_output_enabled = false;
+    return settings;
+  }
+
+}  // namespace isai
@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_BENCH_H_INCLUDED
+#define ISAI_GENEPI_BENCH_H_INCLUDED
+
+#include "poly.h"
+#include "solver.h"
+
+#include <cstddef>
+
+namespace isai
+{
+
+  // amplitude of uniform noise added to benchmark training data (relative to
+  // error threshold - small enough for target itself to meet threshold with
+  // every metric)
+  constexpr const double BENCH_NOISE_AMPLITUDE = 0.5;
+
+  // k-th target polynomial of benchmark set shared by genepa_tts and
+  // genepa_tune - depends on k only, so that set of targets stays the same
+  // regardless of options (reseeds random engine)
+  polynomial_t< 4 > bench_target( std::size_t k );
+
+  // training data of given target drawn with random engine of calling
+  // thread as given settings ask, with noise added to values, so that least
+  // squares fit does not hit target exactly
+  training_data_t bench_training_data( polynomial_t< 4 > target,
+                                       ga_settings_t const &settings );
+
+  // given settings prepared for benchmark runs - silent, without file
+  // output and without shortcuts that would let runs skip search
+  // (least-squares warm start, solution cache)
+  ga_settings_t bench_settings( ga_settings_t settings );
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_BENCH_H_INCLUDED
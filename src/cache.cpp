@@ -0,0 +1,323 @@
+#include "cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace isai
+{
+
+  namespace
+  {
+    constexpr const char CACHE_MAGIC[ 8 ] = { 'G', 'E', 'N', 'E',
+                                               'P', 'A', 'S', 'C' };
+    constexpr const std::uint32_t CACHE_VERSION = 1u;
+    constexpr const std::size_t MAX_COEFFS = 8u;
+    constexpr const std::size_t INITIAL_CAPACITY = 64u;
+
+    struct cache_header_t
+    {
+      char magic[ 8 ];
+      std::uint32_t version;
+      std::uint32_t record_size;
+      std::uint64_t record_count;
+      std::uint64_t lookup_count;
+      std::uint64_t exact_hit_count;
+      std::uint64_t near_hit_count;
+    };
+
+    struct cache_record_t
+    {
+      data_fingerprint_t fp;
+      std::uint32_t metric;
+      std::uint32_t coeff_count;
+      double coeffs[ MAX_COEFFS ];
+      double error;
+    };
+
+    // capacity of cache file of given size
+    std::size_t record_capacity( std::size_t size ) noexcept
+    {
+      return ( size - sizeof( cache_header_t ) ) / sizeof( cache_record_t );
+    }
+
+    std::size_t file_size( std::size_t capacity ) noexcept
+    {
+      return sizeof( cache_header_t ) + capacity * sizeof( cache_record_t );
+    }
+
+    cache_header_t *header( mapped_file_t const &file ) noexcept
+    {
+      return reinterpret_cast< cache_header_t * >( file.data() );
+    }
+
+    cache_record_t *records( mapped_file_t const &file ) noexcept
+    {
+      return reinterpret_cast< cache_record_t * >( file.data() +
+                                                   sizeof( cache_header_t ) );
+    }
+
+    // exclusive lock of cache file for lifetime of guard - mapping is
+    // refreshed once lock is taken, as other process may have grown file
+    class cache_lock_t
+    {
+    public:
+      explicit cache_lock_t( mapped_file_t &file ) :
+        m_file( file ),
+        m_is_locked( file.lock() ),
+        m_is_valid( m_is_locked && file.remap_if_resized() &&
+                    file.size() >= file_size( 0u ) )
+      {
+      }
+
+      cache_lock_t( cache_lock_t const & ) = delete;
+      cache_lock_t &operator=( cache_lock_t const & ) = delete;
+
+      ~cache_lock_t()
+      {
+        if ( m_is_locked && m_file.is_open() )
+        {
+          m_file.unlock();
+        }
+      }
+
+      // true if lock is held and whole file is mapped
+      bool is_valid() const noexcept { return m_is_valid; }
+
+    private:
+      mapped_file_t &m_file;
+      bool m_is_locked;
+      bool m_is_valid;
+    };
+
+    // fnv-1a hash of given bytes
+    std::uint64_t hash_bytes( std::uint64_t hash, void const *data_p,
+                              std::size_t size ) noexcept
+    {
+      auto bytes_p = static_cast< unsigned char const * >( data_p );
+      for ( auto i = std::size_t{ 0 }; i < size; i++ )
+      {
+        hash ^= bytes_p[ i ];
+        hash *= 0x100000001b3u;
+      }
+      return hash;
+    }
+  }  // namespace
+
+
+  data_fingerprint_t fingerprint( training_data_t const &td )
+  {
+    auto res = data_fingerprint_t{};
+    res.hash = 0xcbf29ce484222325u;
+    res.count = td.size();
+    if ( td.empty() )
+    {
+      return res;
+    }
+
+    res.x_min = res.x_max = td.front().x;
+    res.y_min = res.y_max = td.front().y;
+    auto w_sum = double{ 0.0 };
+    auto wy_sum = double{ 0.0 };
+    for ( auto &&dp : td )
+    {
+      res.hash = hash_bytes( res.hash, &dp.x, sizeof( dp.x ) );
+      res.hash = hash_bytes( res.hash, &dp.y, sizeof( dp.y ) );
+      res.hash = hash_bytes( res.hash, &dp.w, sizeof( dp.w ) );
+      res.x_min = std::min( res.x_min, dp.x );
+      res.x_max = std::max( res.x_max, dp.x );
+      res.y_min = std::min( res.y_min, dp.y );
+      res.y_max = std::max( res.y_max, dp.y );
+      w_sum += dp.w;
+      wy_sum += dp.w * dp.y;
+    }
+    if ( w_sum > 0.0 )
+    {
+      res.y_mean = wy_sum / w_sum;
+      auto var = double{ 0.0 };
+      for ( auto &&dp : td )
+      {
+        var += dp.w * ( dp.y - res.y_mean ) * ( dp.y - res.y_mean );
+      }
+      res.y_dev = std::sqrt( var / w_sum );
+    }
+    return res;
+  }
+
+  double fingerprint_distance( data_fingerprint_t const &lhs,
+                               data_fingerprint_t const &rhs )
+  {
+    auto x_width = std::max( { lhs.x_max - lhs.x_min, rhs.x_max - rhs.x_min,
+                               1e-12 } );
+    auto y_width = std::max( { lhs.y_max - lhs.y_min, rhs.y_max - rhs.y_min,
+                               1e-12 } );
+    return std::max( { std::abs( lhs.x_min - rhs.x_min ) / x_width,
+                       std::abs( lhs.x_max - rhs.x_max ) / x_width,
+                       std::abs( lhs.y_min - rhs.y_min ) / y_width,
+                       std::abs( lhs.y_max - rhs.y_max ) / y_width,
+                       std::abs( lhs.y_mean - rhs.y_mean ) / y_width,
+                       std::abs( lhs.y_dev - rhs.y_dev ) / y_width } );
+  }
+
+
+  bool solution_cache_t::open( std::string const &path )
+  {
+    if ( !m_file.open_existing( path, file_size( INITIAL_CAPACITY ) ) )
+    {
+      return false;
+    }
+    auto lock = cache_lock_t{ m_file };
+    if ( !lock.is_valid() )
+    {
+      m_file.close();
+      return false;
+    }
+
+    auto head_p = header( m_file );
+    if ( head_p->magic[ 0 ] == '\0' && head_p->version == 0u )
+    {
+      // new file (zeroed by growing it)
+      std::memcpy( head_p->magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+      head_p->version = CACHE_VERSION;
+      head_p->record_size = sizeof( cache_record_t );
+    }
+    if ( std::memcmp( head_p->magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) !=
+           0 ||
+         head_p->version != CACHE_VERSION ||
+         head_p->record_size != sizeof( cache_record_t ) ||
+         head_p->record_count > record_capacity( m_file.size() ) )
+    {
+      m_file.close();
+      return false;
+    }
+    return true;
+  }
+
+  std::vector< cache_match_t >
+  solution_cache_t::lookup( data_fingerprint_t const &fp,
+                            std::size_t coeff_count, metric_kind_t metric,
+                            double tolerance, std::size_t max_count )
+  {
+    auto res = std::vector< cache_match_t >{};
+    if ( !is_open() )
+    {
+      return res;
+    }
+    auto lock = cache_lock_t{ m_file };
+    if ( !lock.is_valid() )
+    {
+      return res;
+    }
+
+    auto head_p = header( m_file );
+    auto recs_p = records( m_file );
+    for ( auto i = std::size_t{ 0 }; i < head_p->record_count; i++ )
+    {
+      auto &&rec = recs_p[ i ];
+      if ( rec.coeff_count != coeff_count ||
+           rec.metric != static_cast< std::uint32_t >( metric ) )
+      {
+        continue;
+      }
+
+      auto match = cache_match_t{};
+      match.is_exact = rec.fp.hash == fp.hash && rec.fp.count == fp.count;
+      match.distance =
+        match.is_exact ? 0.0 : fingerprint_distance( rec.fp, fp );
+      if ( !match.is_exact && match.distance > tolerance )
+      {
+        continue;
+      }
+      match.coeffs.assign( rec.coeffs, rec.coeffs + coeff_count );
+      match.error = rec.error;
+
+      // the same solution may have been stored several times
+      auto dup_it = std::find_if( std::begin( res ), std::end( res ),
+                                  [&match]( cache_match_t const &m ) {
+                                    return m.coeffs == match.coeffs;
+                                  } );
+      if ( dup_it == std::end( res ) )
+      {
+        res.push_back( std::move( match ) );
+      }
+      else if ( match.is_exact && !dup_it->is_exact )
+      {
+        *dup_it = std::move( match );
+      }
+    }
+
+    std::sort( std::begin( res ), std::end( res ),
+               []( cache_match_t const &lhs, cache_match_t const &rhs ) {
+                 if ( lhs.is_exact != rhs.is_exact )
+                 {
+                   return lhs.is_exact;
+                 }
+                 if ( lhs.distance != rhs.distance )
+                 {
+                   return lhs.distance < rhs.distance;
+                 }
+                 return lhs.error < rhs.error;
+               } );
+    if ( res.size() > max_count )
+    {
+      res.resize( max_count );
+    }
+
+    head_p->lookup_count++;
+    if ( !res.empty() )
+    {
+      ( res.front().is_exact ? head_p->exact_hit_count
+                             : head_p->near_hit_count )++;
+    }
+    return res;
+  }
+
+  bool solution_cache_t::store( data_fingerprint_t const &fp,
+                                std::vector< double > const &coeffs,
+                                double error, metric_kind_t metric )
+  {
+    if ( !is_open() || coeffs.size() > MAX_COEFFS || !std::isfinite( error ) )
+    {
+      return false;
+    }
+    auto lock = cache_lock_t{ m_file };
+    if ( !lock.is_valid() )
+    {
+      return false;
+    }
+
+    auto count = header( m_file )->record_count;
+    auto capacity = record_capacity( m_file.size() );
+    if ( count == capacity && !m_file.resize( file_size( 2u * capacity ) ) )
+    {
+      return false;
+    }
+
+    auto &rec = records( m_file )[ count ];
+    rec = cache_record_t{};
+    rec.fp = fp;
+    rec.metric = static_cast< std::uint32_t >( metric );
+    rec.coeff_count = static_cast< std::uint32_t >( coeffs.size() );
+    std::copy( std::begin( coeffs ), std::end( coeffs ), rec.coeffs );
+    rec.error = error;
+
+    // record is complete before it is counted
+    header( m_file )->record_count = count + 1u;
+    return true;
+  }
+
+  cache_stats_t solution_cache_t::stats() const noexcept
+  {
+    auto res = cache_stats_t{};
+    if ( is_open() )
+    {
+      auto head_p = header( m_file );
+      res.entry_count = head_p->record_count;
+      res.lookup_count = head_p->lookup_count;
+      res.exact_hit_count = head_p->exact_hit_count;
+      res.near_hit_count = head_p->near_hit_count;
+    }
+    return res;
+  }
+
+}  // namespace isai
@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_CACHE_H_INCLUDED
+#define ISAI_GENEPI_CACHE_H_INCLUDED
+
+#include "metric.h"
+#include "mmap.h"
+#include "poly.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  // summary identifying training data in solution cache - hash of all
+  // points (exact matches) plus ranges and moments of arguments and values
+  // (near matches, e.g. the same function sampled again with noise)
+  struct data_fingerprint_t
+  {
+    std::uint64_t hash = 0u;
+    std::uint64_t count = 0u;
+    double x_min = 0.0;
+    double x_max = 0.0;
+    double y_min = 0.0;
+    double y_max = 0.0;
+    double y_mean = 0.0;  // weighted
+    double y_dev = 0.0;   // weighted standard deviation
+  };
+
+  // computes fingerprint of given training data
+  data_fingerprint_t fingerprint( training_data_t const &td );
+
+  // relative distance of summaries of given fingerprints (differences of
+  // argument ranges relative to argument range width, of value summaries
+  // relative to value range width; largest one is returned)
+  double fingerprint_distance( data_fingerprint_t const &lhs,
+                               data_fingerprint_t const &rhs );
+
+  // cached solution matching looked up fingerprint
+  struct cache_match_t
+  {
+    std::vector< double > coeffs;  // a_0 first
+    double error = 0.0;            // on training data it was found for
+    double distance = 0.0;         // of fingerprints (0 for exact match)
+    bool is_exact = false;
+  };
+
+  // usage statistics kept in cache file
+  struct cache_stats_t
+  {
+    std::uint64_t entry_count = 0u;
+    std::uint64_t lookup_count = 0u;
+    std::uint64_t exact_hit_count = 0u;
+    std::uint64_t near_hit_count = 0u;
+  };
+
+  // persistent store of solutions found for training data - append-only,
+  // memory-mapped file of fixed-size records (fingerprint, metric,
+  // coefficients and error), searched linearly; file grows geometrically,
+  // header holds record count and usage statistics; processes sharing file
+  // take its advisory lock (flock) while they read or update it
+  class solution_cache_t
+  {
+  public:
+    // opens cache file at given path (creates it if it does not exist);
+    // returns false on failure or if file is not cache file
+    bool open( std::string const &path );
+
+    // unmaps and closes cache file
+    void close() noexcept { m_file.close(); }
+
+    bool is_open() const noexcept { return m_file.is_open(); }
+
+    // finds up to given number of distinct solutions with given number of
+    // coefficients found for data of given fingerprint (exact matches) or
+    // of fingerprint within given distance (near matches), for given
+    // metric; exact matches come first, then by distance and error;
+    // updates usage statistics
+    std::vector< cache_match_t > lookup( data_fingerprint_t const &fp,
+                                         std::size_t coeff_count,
+                                         metric_kind_t metric,
+                                         double tolerance,
+                                         std::size_t max_count );
+
+    // appends solution found for data of given fingerprint; returns false
+    // if it cannot be stored
+    bool store( data_fingerprint_t const &fp,
+                std::vector< double > const &coeffs, double error,
+                metric_kind_t metric );
+
+    // current usage statistics
+    cache_stats_t stats() const noexcept;
+
+  private:
+    mapped_file_t m_file;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_CACHE_H_INCLUDED
@@ -0,0 +1,356 @@
+#include "genepa.h"
+
+#include "alg.h"
+#include "batch.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+// concrete solver behind opaque c handle (with its own random engines, so
+// that seeded runs reproduce whichever thread steps it)
+struct genepa_solver_t
+{
+  isai::genetic_algorithm_t< 35 > ga;
+  isai::prng_t::state_t rng;
+};
+
+namespace
+{
+  // makes given random state current one of calling thread for scope's
+  // lifetime (stores advanced state back and restores thread's own one)
+  class rng_scope_t
+  {
+  public:
+    explicit rng_scope_t( isai::prng_t::state_t &state ) :
+      m_state( state ),
+      m_saved( isai::prng_t::exchange_state( state ) )
+    {
+    }
+
+    rng_scope_t( rng_scope_t const & ) = delete;
+    rng_scope_t &operator=( rng_scope_t const & ) = delete;
+
+    ~rng_scope_t() { m_state = isai::prng_t::exchange_state( m_saved ); }
+
+  private:
+    isai::prng_t::state_t &m_state;
+    isai::prng_t::state_t m_saved;
+  };
+
+  // seeds random engines of calling thread as requested by settings
+  void seed_engine( genepa_settings_t const &s )
+  {
+    if ( s.seed != 0u )
+    {
+      isai::prng_t::seed( s.seed );
+    }
+    else
+    {
+      isai::prng_t::initialize();
+    }
+  }
+
+  // size of settings struct of version 1 (before metric fields were added)
+  constexpr const auto SETTINGS_V1_SIZE =
+    offsetof( genepa_settings_t, error_metric );
+
+  bool has_metric_fields( genepa_settings_t const &s )
+  {
+    return s.struct_size >= sizeof( genepa_settings_t );
+  }
+
+  // converts c settings into engine ones (no console or file output)
+  isai::ga_settings_t to_ga_settings( genepa_settings_t const &s )
+  {
+    auto res = isai::ga_settings_t{};
+    res.pop_size = s.pop_size;
+    res.max_gens = s.max_gens;
+    res.mutation_rate_growth_threshold = s.mutation_rate_growth_threshold;
+    res.pop_reset_threshold = s.pop_reset_threshold;
+    res.error_threshold = s.error_threshold;
+    res.base_mutation_rate = s.base_mutation_rate;
+    res.small_progress_rate_threshold = s.small_progress_rate_threshold;
+    res.mutation_rate_growth_coeff = s.mutation_rate_growth_coeff;
+    res.is_input_random = false;
+    res.is_verbose = false;
+    res.is_quiet = true;
+    res.is_file_output_enabled = false;
+    if ( has_metric_fields( s ) )
+    {
+      res.error_metric = static_cast< isai::metric_kind_t >( s.error_metric );
+      res.huber_delta = s.huber_delta;
+    }
+    return res;
+  }
+
+  bool is_valid( genepa_settings_t const &s )
+  {
+    return s.struct_size >= SETTINGS_V1_SIZE && s.pop_size > 1 &&
+           s.max_gens > 0 && s.error_threshold > 0.0 &&
+           s.base_mutation_rate >= 0.0 && s.base_mutation_rate <= 1.0 &&
+           ( !has_metric_fields( s ) ||
+             ( s.error_metric >= GENEPA_METRIC_L1 &&
+               s.error_metric <= GENEPA_METRIC_HUBER && s.huber_delta > 0.0 ) );
+  }
+}  // namespace
+
+extern "C" {
+
+int genepa_version( void ) { return GENEPA_VERSION; }
+
+int genepa_settings_init( genepa_settings_t *settings )
+{
+  if ( settings == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  auto defaults = isai::ga_settings_t{};
+  settings->struct_size = sizeof( genepa_settings_t );
+  settings->pop_size = defaults.pop_size;
+  settings->max_gens = defaults.max_gens;
+  settings->mutation_rate_growth_threshold =
+    defaults.mutation_rate_growth_threshold;
+  settings->pop_reset_threshold = defaults.pop_reset_threshold;
+  settings->error_threshold = defaults.error_threshold;
+  settings->base_mutation_rate = defaults.base_mutation_rate;
+  settings->small_progress_rate_threshold =
+    defaults.small_progress_rate_threshold;
+  settings->mutation_rate_growth_coeff = defaults.mutation_rate_growth_coeff;
+  settings->seed = 0u;
+  settings->error_metric = GENEPA_METRIC_L1;
+  settings->huber_delta = defaults.huber_delta;
+  return GENEPA_OK;
+}
+
+int genepa_progress_init( genepa_progress_t *progress )
+{
+  if ( progress == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+  *progress = genepa_progress_t{};
+  progress->struct_size = sizeof( genepa_progress_t );
+  return GENEPA_OK;
+}
+
+genepa_solver_t *genepa_create( genepa_settings_t const *settings,
+                                double const *xs, double const *ys,
+                                size_t count )
+{
+  if ( settings == nullptr || xs == nullptr || ys == nullptr || count == 0 ||
+       !is_valid( *settings ) )
+  {
+    return nullptr;
+  }
+
+  try
+  {
+    auto tdata = isai::training_data_t{};
+    tdata.reserve( count );
+    for ( auto i = std::size_t{ 0 }; i < count; i++ )
+    {
+      tdata.push_back( isai::data_point_t{ xs[ i ], ys[ i ] } );
+    }
+
+    // initial population is drawn from solver's own engines already
+    auto rng = isai::prng_t::state_t{};
+    auto res = std::unique_ptr< genepa_solver_t >{};
+    {
+      auto scope = rng_scope_t{ rng };
+      seed_engine( *settings );
+      res.reset( new genepa_solver_t{
+        isai::genetic_algorithm_t< 35 >{ to_ga_settings( *settings ),
+                                         std::move( tdata ) },
+        isai::prng_t::state_t{} } );
+    }
+    res->rng = rng;
+    return res.release();
+  }
+  catch ( ... )
+  {
+    return nullptr;
+  }
+}
+
+int genepa_step( genepa_solver_t *solver, size_t generations )
+{
+  if ( solver == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  try
+  {
+    auto scope = rng_scope_t{ solver->rng };
+    for ( auto i = std::size_t{ 0 }; i < generations; i++ )
+    {
+      if ( !solver->ga.step() )
+      {
+        return GENEPA_DONE;
+      }
+    }
+    return solver->ga.is_done() ? GENEPA_DONE : GENEPA_OK;
+  }
+  catch ( std::bad_alloc const & )
+  {
+    return GENEPA_ERR_OUT_OF_MEMORY;
+  }
+  catch ( ... )
+  {
+    return GENEPA_ERR_INTERNAL;
+  }
+}
+
+int genepa_run( genepa_solver_t *solver )
+{
+  if ( solver == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  try
+  {
+    auto scope = rng_scope_t{ solver->rng };
+    solver->ga.run();
+    return GENEPA_DONE;
+  }
+  catch ( std::bad_alloc const & )
+  {
+    return GENEPA_ERR_OUT_OF_MEMORY;
+  }
+  catch ( ... )
+  {
+    return GENEPA_ERR_INTERNAL;
+  }
+}
+
+int genepa_get_progress( genepa_solver_t const *solver,
+                         genepa_progress_t *progress )
+{
+  if ( solver == nullptr || progress == nullptr ||
+       progress->struct_size < sizeof( genepa_progress_t ) )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  auto snap = solver->ga.snapshot();
+  progress->generation = snap.generation;
+  progress->best_error = snap.best_error;
+  progress->avg_error = snap.avg_error;
+  progress->mutation_rate = snap.mutation_rate;
+  progress->is_done = snap.is_done ? 1 : 0;
+  return GENEPA_OK;
+}
+
+int genepa_get_best_coeffs( genepa_solver_t const *solver, double *coeffs,
+                            size_t capacity )
+{
+  if ( solver == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  // every snapshot holds coefficients of the same polynomial size
+  constexpr const auto coeff_count = std::size_t{ 5 };
+  auto snap = solver->ga.snapshot();
+  if ( coeffs != nullptr && capacity >= coeff_count )
+  {
+    for ( auto i = std::size_t{ 0 }; i < coeff_count; i++ )
+    {
+      coeffs[ i ] = snap.coeffs[ i ];
+    }
+  }
+  return static_cast< int >( coeff_count );
+}
+
+int genepa_cancel( genepa_solver_t *solver )
+{
+  if ( solver == nullptr )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  solver->ga.cancel();
+  return GENEPA_OK;
+}
+
+int genepa_fit_batch( genepa_settings_t const *settings, size_t problem_count,
+                      size_t const *point_counts, double const *xs,
+                      double const *ys, double *coeffs, size_t coeff_stride,
+                      double *errors )
+{
+  if ( settings == nullptr || point_counts == nullptr || xs == nullptr ||
+       ys == nullptr || coeffs == nullptr || problem_count == 0 ||
+       !is_valid( *settings ) )
+  {
+    return GENEPA_ERR_INVALID_ARGUMENT;
+  }
+
+  try
+  {
+    // batch runs in calling thread, on engines of its own
+    auto rng = isai::prng_t::state_t{};
+    auto scope = rng_scope_t{ rng };
+    seed_engine( *settings );
+
+    auto problems = std::vector< isai::training_data_t >( problem_count );
+    auto offset = std::size_t{ 0 };
+    for ( auto p = std::size_t{ 0 }; p < problem_count; p++ )
+    {
+      if ( point_counts[ p ] == 0 )
+      {
+        return GENEPA_ERR_INVALID_ARGUMENT;
+      }
+      problems[ p ].reserve( point_counts[ p ] );
+      for ( auto j = std::size_t{ 0 }; j < point_counts[ p ]; j++ )
+      {
+        problems[ p ].push_back(
+          isai::data_point_t{ xs[ offset + j ], ys[ offset + j ] } );
+      }
+      offset += point_counts[ p ];
+    }
+
+    auto ga_settings = to_ga_settings( *settings );
+    return isai::dispatch_metric(
+      ga_settings.error_metric, ga_settings.huber_delta, [&]( auto metric ) {
+        auto batch =
+          isai::batched_genetic_algorithm_t< 35, decltype( metric ) >{
+            ga_settings, std::move( problems ), metric };
+        batch.run();
+
+        auto coeff_count = std::size_t{ 0 };
+        for ( auto p = std::size_t{ 0 }; p < problem_count; p++ )
+        {
+          auto &&[ poly, err ] = batch.result( p );
+          coeff_count = poly.size();
+          if ( coeff_count > coeff_stride )
+          {
+            break;
+          }
+          for ( auto k = std::size_t{ 0 }; k < coeff_count; k++ )
+          {
+            coeffs[ p * coeff_stride + k ] = poly[ k ];
+          }
+          if ( errors != nullptr )
+          {
+            errors[ p ] = err;
+          }
+        }
+        return static_cast< int >( coeff_count );
+      } );
+  }
+  catch ( std::bad_alloc const & )
+  {
+    return GENEPA_ERR_OUT_OF_MEMORY;
+  }
+  catch ( ... )
+  {
+    return GENEPA_ERR_INTERNAL;
+  }
+}
+
+void genepa_destroy( genepa_solver_t *solver ) { delete solver; }
+
+}  // extern "C"
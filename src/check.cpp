@@ -0,0 +1,933 @@
+#include "alg.h"
+#include "cache.h"
+#include "chromo.h"
+#include "coreset.h"
+#include "dist.h"
+#include "eval.h"
+#include "exact.h"
+#include "metric.h"
+#include "pool.h"
+#include "prng.h"
+#include "progressive.h"
+#include "rates.h"
+#include "seqlock.h"
+#include "shuffle.h"
+#include "slice.h"
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// self checks of engine internals whose correctness is not visible in
+// results of whole algorithm (bit tricks, encodings) - each check prints
+// its name and verdict, program fails if any of them does
+//
+// usage: genepa_check [--genepa PATH]
+//        (checks that need genepa executable are skipped without its path)
+
+using chromo_t = isai::chromosome_t< 35 >;
+
+extern char **environ;  // NOLINT
+
+// path of genepa executable (empty - not given)
+static std::string s_genepa_path;  // NOLINT
+
+
+// random population of given size
+isai::population_t< 35 > random_population( std::size_t size )
+{
+  auto res = isai::population_t< 35 >{};
+  res.reserve( size );
+  for ( auto i = std::size_t{ 0 }; i < size; i++ )
+  {
+    res.emplace_back();
+  }
+  return res;
+}
+
+// given number of points of random quartic with gaussian-like noise and
+// random weights
+isai::training_data_t noisy_data( std::size_t count )
+{
+  auto poly = isai::to_polynomial( chromo_t{} );
+  auto res = poly.get_training_data( count );
+  for ( auto &&dp : res )
+  {
+    auto noise = 0.0;
+    for ( auto i = 0; i < 4; i++ )
+    {
+      noise += isai::prng_t::get_fraction() - 0.5;
+    }
+    dp.y += 20.0 * noise;
+    dp.w = 0.5 + isai::prng_t::get_fraction();
+  }
+  return res;
+}
+
+// all error metrics
+constexpr const isai::metric_kind_t ALL_METRICS[] = {
+  isai::metric_kind_t::l1, isai::metric_kind_t::l2, isai::metric_kind_t::linf,
+  isai::metric_kind_t::huber
+};
+
+// transposing 64 x 64 bit matrix moves bit j of word i to bit i of word j,
+// and transposing it again restores it
+bool check_transpose_bits()
+{
+  std::uint64_t words[ isai::SLICE_LANES ];
+  std::uint64_t orig[ isai::SLICE_LANES ];
+  for ( auto i = std::size_t{ 0 }; i < isai::SLICE_LANES; i++ )
+  {
+    words[ i ] = orig[ i ] = isai::prng_t::get_word();
+  }
+
+  isai::transpose_bits( words );
+  auto is_ok = true;
+  for ( auto i = std::size_t{ 0 }; i < isai::SLICE_LANES; i++ )
+  {
+    for ( auto j = std::size_t{ 0 }; j < isai::SLICE_LANES; j++ )
+    {
+      is_ok = is_ok && ( ( words[ i ] >> j ) & 1u ) ==
+                         ( ( orig[ j ] >> i ) & 1u );
+    }
+  }
+
+  isai::transpose_bits( words );
+  for ( auto i = std::size_t{ 0 }; i < isai::SLICE_LANES; i++ )
+  {
+    is_ok = is_ok && words[ i ] == orig[ i ];
+  }
+  return is_ok;
+}
+
+// the same for 8 x 8 bit matrix held in single word (byte = row)
+bool check_transpose_byte_bits()
+{
+  auto is_ok = true;
+  for ( auto n = 0; n < 1000; n++ )
+  {
+    auto word = isai::prng_t::get_word();
+    auto res = isai::transpose_byte_bits( word );
+    for ( auto r = 0u; r < 8u; r++ )
+    {
+      for ( auto c = 0u; c < 8u; c++ )
+      {
+        is_ok = is_ok && ( ( res >> ( 8u * r + c ) ) & 1u ) ==
+                           ( ( word >> ( 8u * c + r ) ) & 1u );
+      }
+    }
+    is_ok = is_ok && isai::transpose_byte_bits( res ) == word;
+  }
+  return is_ok;
+}
+
+// coefficients decoded from slices are those of to_polynomial (population
+// size is not multiple of block size, so that partial block is covered)
+bool check_sliced_decode()
+{
+  auto pop = random_population( 150u );
+  auto sliced = isai::sliced_population_t< 35 >{ pop.size() };
+  auto coeffs = std::vector< double >( isai::SLICE_LANES * 5u );
+
+  auto is_ok = true;
+  for ( auto b = std::size_t{ 0 }; b < sliced.block_count(); b++ )
+  {
+    sliced.load( b, pop );
+    sliced.decode( b, coeffs.data() );
+    for ( auto j = std::size_t{ 0 }; j < sliced.lane_count( b ); j++ )
+    {
+      auto poly = isai::to_polynomial( pop[ b * isai::SLICE_LANES + j ] );
+      for ( auto k = std::size_t{ 0 }; k < poly.size(); k++ )
+      {
+        is_ok = is_ok && coeffs[ j * 5u + k ] == poly[ k ];
+      }
+    }
+  }
+  return is_ok;
+}
+
+// sliced breeding without mutation yields children of chromosome_t
+// crossover at the same points (points breed draws are predicted from
+// the same seed, crossover is given them by reseeding engine until it
+// draws them)
+bool check_sliced_breed()
+{
+  constexpr const auto seed = std::uint64_t{ 1234u };
+  auto parents = random_population( 20u );
+  auto children = random_population( 100u );
+  auto sliced = isai::sliced_population_t< 35 >{ children.size() };
+
+  auto ids = std::vector< std::uint32_t >( 2u * children.size() );
+  for ( auto &&id : ids )
+  {
+    id = static_cast< std::uint32_t >(
+      isai::prng_t::get_index( parents.size() ) );
+  }
+
+  isai::prng_t::seed( seed );
+  auto points = std::vector< std::size_t >( children.size() );
+  for ( auto &&p : points )
+  {
+    p = 1u + ( ( isai::prng_t::get_word() >> 32u ) * 35u >> 32u );
+  }
+
+  isai::prng_t::seed( seed );
+  auto thresholds = std::vector< std::uint64_t >( 35u, 0u );
+  auto flips = std::vector< std::uint64_t >( children.size(), 1u );
+  for ( auto b = std::size_t{ 0 }; b < sliced.block_count(); b++ )
+  {
+    sliced.breed( b, parents, ids.data(), thresholds.data(), flips.data() );
+    sliced.store( b, children );
+  }
+
+  auto is_ok = true;
+  for ( auto i = std::size_t{ 0 }; i < children.size(); i++ )
+  {
+    auto value = std::uint64_t{ 0 };
+    do
+    {
+      isai::prng_t::seed( ++value );
+    } while ( isai::prng_t::get_crossover_point< 35 >() != points[ i ] );
+
+    isai::prng_t::seed( value );
+    auto child = chromo_t{ parents[ ids[ 2u * i ] ] }.crossover(
+      parents[ ids[ 2u * i + 1u ] ] );
+    // padding bits of last byte are not genes (and are not sliced)
+    auto genes = ( std::uint64_t{ 1 } << 35u ) - 1u;
+    is_ok = is_ok && ( isai::to_word( child ) & genes ) ==
+                       ( isai::to_word( children[ i ] ) & genes );
+    is_ok = is_ok && flips[ i ] == 0u;
+  }
+  return is_ok;
+}
+
+// bits of random masks are set at requested rate (within five standard
+// deviations), extreme thresholds give constant masks
+bool check_random_mask()
+{
+  constexpr const auto mask_count = std::size_t{ 20000u };
+  auto is_ok = true;
+  for ( auto p : { 0.001, 0.05, 0.3, 0.5, 0.9 } )
+  {
+    auto threshold = isai::mask_threshold( p );
+    auto set_count = std::size_t{ 0 };
+    for ( auto n = std::size_t{ 0 }; n < mask_count; n++ )
+    {
+      auto mask = isai::random_mask( threshold );
+      for ( ; mask != 0u; mask &= mask - 1u )
+      {
+        set_count++;
+      }
+    }
+
+    auto bit_count = static_cast< double >( mask_count * 64u );
+    auto rate = static_cast< double >( set_count ) / bit_count;
+    auto sigma = std::sqrt( p * ( 1.0 - p ) / bit_count );
+    is_ok = is_ok && std::abs( rate - p ) <= 5.0 * sigma;
+  }
+
+  is_ok = is_ok && isai::mask_threshold( 0.0 ) == 0u &&
+          isai::random_mask( 0u ) == 0u &&
+          isai::random_mask( isai::mask_threshold( 1.0 ) ) ==
+            ~std::uint64_t{ 0 };
+  return is_ok;
+}
+
+// skip-sampled mutation flips every gene at its own rate (within five
+// standard deviations; genes of rate 0 never), reports exactly genes it
+// flipped and leaves members outside given range alone
+bool check_skip_sampled_mutation()
+{
+  constexpr const auto member_count = std::size_t{ 40000u };
+  auto rates = std::array< double, 35 >{};
+  for ( auto g = std::size_t{ 0 }; g < rates.size(); g++ )
+  {
+    rates[ g ] = g % 5u == 0u ? 0.0 : 0.002 * static_cast< double >( g );
+  }
+
+  auto pop = random_population( member_count + 2u );
+  auto orig = pop;
+  auto flips = std::vector< std::uint64_t >( pop.size(), 0u );
+  isai::mutate_skip_sampled( pop, 1u, member_count + 1u, rates,
+                             flips.data() );
+
+  auto counts = std::array< double, 35 >{};
+  auto is_ok = true;
+  for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+  {
+    auto diff = isai::to_word( pop[ i ] ) ^ isai::to_word( orig[ i ] );
+    is_ok = is_ok && diff == flips[ i ];
+    for ( auto g = std::size_t{ 0 }; g < counts.size(); g++ )
+    {
+      counts[ g ] += static_cast< double >( ( diff >> g ) & 1u );
+    }
+  }
+  is_ok = is_ok && flips.front() == 0u && flips.back() == 0u;
+
+  auto n = static_cast< double >( member_count );
+  for ( auto g = std::size_t{ 0 }; g < rates.size(); g++ )
+  {
+    auto sigma = std::sqrt( n * rates[ g ] * ( 1.0 - rates[ g ] ) );
+    is_ok = is_ok && std::abs( counts[ g ] - n * rates[ g ] ) <= 5.0 * sigma;
+  }
+  return is_ok;
+}
+
+// 7-bit grid of progressive solver is that of chromosomes, and encoding
+// inverts decoding on it (but for negative zero, which encodes as zero)
+bool check_chromosome_grid()
+{
+  auto grid = isai::coeff_grid_t{ 7u };
+  auto is_ok = true;
+  for ( auto code = std::uint64_t{ 0 }; code < 128u; code++ )
+  {
+    is_ok = is_ok && grid.decode( code ) == isai::COEFF_TABLE[ code ];
+    is_ok = is_ok &&
+            ( code == 1u || grid.encode( grid.decode( code ) ) == code );
+  }
+  return is_ok;
+}
+
+// promotion keeps values - every code of every grid, expanded to every
+// wider grid, decodes to the same value (codes are expanded as many as fit
+// in a word, each in every position)
+bool check_expand_codes()
+{
+  auto is_ok = true;
+  for ( auto bits = isai::MIN_CODE_BITS; bits <= isai::MAX_CODE_BITS; bits++ )
+  {
+    auto grid = isai::coeff_grid_t{ bits };
+    for ( auto wide_bits = bits; wide_bits <= isai::MAX_CODE_BITS;
+          wide_bits++ )
+    {
+      auto wide_grid = isai::coeff_grid_t{ wide_bits };
+      auto count = std::min( std::size_t{ 5 }, 64u / wide_bits );
+      auto mask = ( std::uint64_t{ 1 } << wide_bits ) - 1u;
+      for ( auto code = std::uint64_t{ 0 }; code < ( 1u << bits ); code++ )
+      {
+        for ( auto k = std::size_t{ 0 }; k < count; k++ )
+        {
+          auto word = code << ( k * bits );
+          auto wide = isai::expand_codes( word, count, bits, wide_bits );
+          auto wide_code = ( wide >> ( k * wide_bits ) ) & mask;
+          is_ok = is_ok && wide == wide_code << ( k * wide_bits ) &&
+                  wide_grid.decode( wide_code ) == grid.decode( code );
+        }
+      }
+    }
+  }
+  return is_ok;
+}
+
+// error of given polynomial computed point by point straight from
+// definition of given metric (reference for vectorized kernels)
+double reference_error( isai::polynomial_t< 4 > const &poly,
+                        isai::training_data_t const &td,
+                        isai::metric_kind_t kind, double delta )
+{
+  auto acc = 0.0;
+  auto weight_sum = 0.0;
+  for ( auto &&dp : td )
+  {
+    auto a = std::abs( dp.y - poly( dp.x ) );
+    weight_sum += dp.w;
+    switch ( kind )
+    {
+      case isai::metric_kind_t::l1:
+        acc += dp.w * a;
+        break;
+      case isai::metric_kind_t::l2:
+        acc += dp.w * a * a;
+        break;
+      case isai::metric_kind_t::linf:
+        acc = std::max( acc, dp.w * a );
+        break;
+      case isai::metric_kind_t::huber:
+        acc += dp.w *
+               ( a <= delta ? 0.5 * a * a : delta * ( a - 0.5 * delta ) );
+        break;
+    }
+  }
+  return kind == isai::metric_kind_t::linf ? acc : acc / weight_sum;
+}
+
+// 4-lane error kernels (on plain and power table data) agree with scalar
+// reference for every metric, also for data sizes that need padding
+bool check_metric_kernels()
+{
+  auto is_ok = true;
+  for ( auto size : { 1u, 2u, 3u, 4u, 5u, 7u, 8u, 13u, 50u, 101u } )
+  {
+    auto td = noisy_data( size );
+    auto md = isai::metric_data_t{ td };
+    auto pt = isai::power_table_t{ td, 4u };
+    for ( auto kind : ALL_METRICS )
+    {
+      for ( auto n = 0; n < 20; n++ )
+      {
+        auto chromo = chromo_t{};
+        auto expected = reference_error( isai::to_polynomial( chromo ), td,
+                                         kind, 3.0 );
+        isai::dispatch_metric( kind, 3.0, [&]( auto metric ) {
+          auto tolerance = 1e-9 * std::max( 1.0, expected );
+          is_ok = is_ok &&
+                  std::abs( isai::eval_error( chromo, md, metric ) -
+                            expected ) <= tolerance &&
+                  std::abs( isai::eval_error( chromo, pt, metric ) -
+                            expected ) <= tolerance;
+        } );
+      }
+    }
+  }
+  return is_ok;
+}
+
+// exact solver over 3-coefficient grid finds the same least error as
+// exhaustive search of all 127^3 grid polynomials, for every metric
+bool check_exact_solver()
+{
+  constexpr const int MAX_Q = isai::exact_solver_t< 21 >::MAX_QUARTERS;
+
+  auto td = isai::training_data_t( 8u );
+  auto c0 = 16.0 * isai::prng_t::get_fraction() - 8.0;
+  auto c1 = 16.0 * isai::prng_t::get_fraction() - 8.0;
+  auto c2 = 16.0 * isai::prng_t::get_fraction() - 8.0;
+  for ( auto &&dp : td )
+  {
+    dp.x = 4.0 * isai::prng_t::get_fraction() - 2.0;
+    dp.y = c0 + ( c1 + c2 * dp.x ) * dp.x +
+           4.0 * ( isai::prng_t::get_fraction() +
+                   isai::prng_t::get_fraction() - 1.0 );
+    dp.w = 0.5 + isai::prng_t::get_fraction();
+  }
+
+  auto is_ok = true;
+  for ( auto kind : ALL_METRICS )
+  {
+    auto best = std::numeric_limits< double >::infinity();
+    for ( auto a = -MAX_Q; a <= MAX_Q; a++ )
+    {
+      for ( auto b = -MAX_Q; b <= MAX_Q; b++ )
+      {
+        for ( auto c = -MAX_Q; c <= MAX_Q; c++ )
+        {
+          auto poly = isai::polynomial_t< 4 >{ 0.25 * a, 0.25 * b, 0.25 * c,
+                                               0.0, 0.0 };
+          best = std::min( best, reference_error( poly, td, kind, 3.0 ) );
+        }
+      }
+    }
+
+    auto settings = isai::ga_settings_t{};
+    settings.error_metric = kind;
+    settings.huber_delta = 3.0;
+    settings.thread_count = 2u;
+    auto res = isai::exact_solver_t< 21 >{ settings, td }.solve();
+    auto tolerance = 1e-9 * std::max( 1.0, best );
+    is_ok = is_ok && res.is_optimal && !res.is_cancelled &&
+            std::abs( res.error - best ) <= tolerance;
+  }
+  return is_ok;
+}
+
+// reweighted coreset keeps total weight of training data
+bool check_coreset_weight()
+{
+  auto is_ok = true;
+  for ( auto size : { 50u, 200u, 1000u } )
+  {
+    auto td = noisy_data( 3000u );
+    auto core = isai::training_data_t{};
+    is_ok = is_ok && isai::build_coreset( td, 5u, size, core ) &&
+            core.size() <= size;
+
+    auto full_weight = 0.0;
+    auto core_weight = 0.0;
+    for ( auto &&dp : td )
+    {
+      full_weight += dp.w;
+    }
+    for ( auto &&dp : core )
+    {
+      core_weight += dp.w;
+    }
+    is_ok = is_ok && std::abs( core_weight - full_weight ) <= 1e-9 *
+                                                               full_weight;
+  }
+  return is_ok;
+}
+
+// errors of fixed polynomials on coreset sized for relative error bound
+// stay within that bound of their errors on full data
+bool check_coreset_error_bound()
+{
+  constexpr const double bound = 0.25;
+  auto size = isai::coreset_size_for_error( bound, 5u );
+  auto td = noisy_data( 20000u );
+  auto core = isai::training_data_t{};
+  auto is_ok = isai::build_coreset( td, 5u, size, core );
+  for ( auto kind : { isai::metric_kind_t::l1, isai::metric_kind_t::l2,
+                      isai::metric_kind_t::huber } )
+  {
+    for ( auto n = 0; n < 20; n++ )
+    {
+      auto poly = isai::to_polynomial( chromo_t{} );
+      auto full = reference_error( poly, td, kind, 3.0 );
+      auto reduced = reference_error( poly, core, kind, 3.0 );
+      is_ok = is_ok && std::abs( reduced - full ) <= bound * full;
+    }
+  }
+  return is_ok;
+}
+
+// solution found on coreset that fails on full data makes algorithm drop
+// coreset and report error on full data; solution that passes keeps it
+bool check_coreset_fallback()
+{
+  auto settings = isai::ga_settings_t{};
+  settings.pop_size = 50u;
+  settings.max_gens = 5u;
+  settings.error_threshold = 0.1;
+  settings.coreset_size = 50u;
+  settings.is_quiet = true;
+  settings.warm_start_fraction = 0.0;
+  settings.is_file_output_enabled = false;
+
+  // data lies on seeded grid polynomial, except for single point with
+  // weight too small to be ever sampled, but residual large enough to push
+  // full error over threshold
+  auto target = chromo_t{};
+  auto td = isai::to_polynomial( target ).get_training_data( 1000u );
+  auto kept = isai::genetic_algorithm_t< 35 >{ settings, td };
+  kept.seed( { target } );
+  kept.run();
+
+  td.front().y += 1e9;
+  td.front().w = 1e-6;
+  auto dropped = isai::genetic_algorithm_t< 35 >{ settings, td };
+  dropped.seed( { target } );
+  dropped.run();
+
+  return kept.is_coreset_used() &&
+         kept.best_error() <= settings.error_threshold &&
+         !dropped.is_coreset_used() &&
+         dropped.best_error() > settings.error_threshold &&
+         dropped.result().second > settings.error_threshold;
+}
+
+// shuffles identity permutation of n values given number of times - every
+// result must be permutation, and counts of values of every group landing
+// at positions of every group (consecutive ones) must pass chi-square test
+// of uniformity; values are grouped both by range and by residue, so that
+// neither local nor strided structure survives unnoticed
+bool check_shuffle_uniformity( std::size_t n, std::size_t trials,
+                               isai::thread_pool_t *pool_p )
+{
+  auto groups = std::min( n, std::size_t{ 16 } );
+  auto group_of = [n, groups]( std::size_t i ) { return i * groups / n; };
+  auto group_sizes = std::vector< double >( groups, 0.0 );
+  auto residue_sizes = std::vector< double >( groups, 0.0 );
+  for ( auto i = std::size_t{ 0 }; i < n; i++ )
+  {
+    group_sizes[ group_of( i ) ] += 1.0;
+    residue_sizes[ i % groups ] += 1.0;
+  }
+
+  auto shuffler = isai::scatter_shuffler_t< std::uint32_t >{};
+  auto counts = std::vector< double >( groups * groups, 0.0 );
+  auto residue_counts = std::vector< double >( groups * groups, 0.0 );
+  auto seen = std::vector< bool >( n );
+  auto is_ok = true;
+  for ( auto t = std::size_t{ 0 }; t < trials; t++ )
+  {
+    auto values = std::vector< std::uint32_t >( n );
+    for ( auto i = std::size_t{ 0 }; i < n; i++ )
+    {
+      values[ i ] = static_cast< std::uint32_t >( i );
+    }
+    shuffler.shuffle( values, pool_p );
+
+    std::fill( std::begin( seen ), std::end( seen ), false );
+    is_ok = is_ok && values.size() == n;
+    for ( auto i = std::size_t{ 0 }; i < values.size(); i++ )
+    {
+      auto v = values[ i ];
+      is_ok = is_ok && v < n && !seen[ v ];
+      if ( v < n )
+      {
+        seen[ v ] = true;
+        counts[ group_of( v ) * groups + group_of( i ) ] += 1.0;
+        residue_counts[ ( v % groups ) * groups + group_of( i ) ] += 1.0;
+      }
+    }
+  }
+
+  auto chi2 = [&]( std::vector< double > const &cells,
+                   std::vector< double > const &value_sizes ) {
+    auto res = 0.0;
+    for ( auto gv = std::size_t{ 0 }; gv < groups; gv++ )
+    {
+      for ( auto gp = std::size_t{ 0 }; gp < groups; gp++ )
+      {
+        auto expected = static_cast< double >( trials ) * value_sizes[ gv ] *
+                        group_sizes[ gp ] / static_cast< double >( n );
+        auto diff = cells[ gv * groups + gp ] - expected;
+        res += diff * diff / expected;
+      }
+    }
+    return res;
+  };
+
+  // 0.999 quantile of chi-square distribution (wilson-hilferty)
+  auto dof = static_cast< double >( ( groups - 1u ) * ( groups - 1u ) );
+  auto a = 2.0 / ( 9.0 * dof );
+  auto limit = dof * std::pow( 1.0 - a + 3.09 * std::sqrt( a ), 3.0 );
+  return is_ok && chi2( counts, group_sizes ) <= limit &&
+         chi2( residue_counts, residue_sizes ) <= limit;
+}
+
+// scatter shuffler gives uniformly random permutations - both small inputs
+// (shuffled directly) and ones split into chunks and buckets, serially and
+// in parallel
+bool check_scatter_shuffle()
+{
+  using shuffler_t = isai::scatter_shuffler_t< std::uint32_t >;
+  auto large = 3u * shuffler_t::CHUNK_SIZE + 100u;
+  auto pool = isai::thread_pool_t{ 3u };
+  return check_shuffle_uniformity( 10u, 20000u, nullptr ) &&
+         check_shuffle_uniformity( large, 50u, nullptr ) &&
+         check_shuffle_uniformity( large, 50u, &pool );
+}
+
+// solutions stored in cache survive reopening - exact hit for the same
+// data, near hit for noisy resample of the same function (only within
+// tolerance) - and processes storing concurrently lose no records
+bool check_solution_cache()
+{
+  auto path = "/tmp/genepa_check_cache." + std::to_string( ::getpid() );
+  ::unlink( path.c_str() );
+
+  auto poly = isai::to_polynomial( chromo_t{} );
+  auto coeffs = std::vector< double >( &poly[ 0 ], &poly[ 0 ] + poly.size() );
+  auto td = poly.get_training_data( 200u );
+  auto resampled = td;
+  for ( auto &&dp : resampled )
+  {
+    dp.y += 0.01 * ( isai::prng_t::get_fraction() - 0.5 );
+  }
+  auto fp = isai::fingerprint( td );
+  auto near_fp = isai::fingerprint( resampled );
+
+  auto is_ok = true;
+  {
+    auto cache = isai::solution_cache_t{};
+    is_ok = cache.open( path ) &&
+            cache.store( fp, coeffs, 0.5, isai::metric_kind_t::l1 );
+  }
+
+  auto cache = isai::solution_cache_t{};
+  is_ok = is_ok && cache.open( path );
+  auto exact =
+    cache.lookup( fp, coeffs.size(), isai::metric_kind_t::l1, 0.0, 4u );
+  auto near =
+    cache.lookup( near_fp, coeffs.size(), isai::metric_kind_t::l1, 0.1, 4u );
+  auto too_far =
+    cache.lookup( near_fp, coeffs.size(), isai::metric_kind_t::l1, 0.0, 4u );
+  auto other_metric =
+    cache.lookup( fp, coeffs.size(), isai::metric_kind_t::l2, 0.1, 4u );
+  is_ok = is_ok && exact.size() == 1u && exact[ 0 ].is_exact &&
+          exact[ 0 ].coeffs == coeffs && exact[ 0 ].error == 0.5 &&
+          near.size() == 1u && !near[ 0 ].is_exact &&
+          near[ 0 ].distance <= 0.1 && near[ 0 ].coeffs == coeffs &&
+          too_far.empty() && other_metric.empty();
+  cache.close();
+
+  // writers open cache at once (released by closing pipe) and take turns,
+  // so that every one of them stores into file grown by others
+  constexpr const int writers = 4;
+  constexpr const int records_per_writer = 200;
+  int gate[ 2 ];
+  is_ok = is_ok && ::pipe( gate ) == 0;
+  auto pids = std::vector< pid_t >{};
+  for ( auto w = 0; is_ok && w < writers; w++ )
+  {
+    auto pid = ::fork();
+    if ( pid == 0 )
+    {
+      ::close( gate[ 1 ] );
+      auto writer = isai::solution_cache_t{};
+      auto is_stored = writer.open( path );
+      char byte;
+      is_stored = is_stored && ::read( gate[ 0 ], &byte, 1u ) == 0;
+      for ( auto i = 0; i < records_per_writer; i++ )
+      {
+        is_stored = is_stored &&
+                    writer.store( fp, { 1.0 * w, 1.0 * i }, 1.0,
+                                  isai::metric_kind_t::l2 );
+        std::this_thread::yield();
+      }
+      ::_exit( is_stored ? 0 : 1 );
+    }
+    is_ok = is_ok && pid > 0;
+    pids.push_back( pid );
+  }
+  ::close( gate[ 0 ] );
+  ::close( gate[ 1 ] );
+  for ( auto pid : pids )
+  {
+    auto status = 0;
+    is_ok = is_ok && pid > 0 && ::waitpid( pid, &status, 0 ) == pid &&
+            WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+  }
+
+  is_ok = is_ok && cache.open( path );
+  auto stored =
+    cache.lookup( fp, 2u, isai::metric_kind_t::l2, 0.0, 2u * writers *
+                                                          records_per_writer );
+  is_ok = is_ok &&
+          cache.stats().entry_count == 1u + writers * records_per_writer &&
+          stored.size() == writers * records_per_writer;
+  cache.close();
+  ::unlink( path.c_str() );
+  return is_ok;
+}
+
+// values read from seqlock while single writer keeps publishing are never
+// torn (all words of value come from the same store) and never go back
+bool check_seqlock()
+{
+  using value_t = std::array< std::uint64_t, 8u >;
+
+  auto lock = isai::seqlock_t< value_t >{};
+  auto reader_count = std::atomic< int >{ 0 };
+  auto is_writing = std::atomic< bool >{ true };
+  auto is_ok = std::atomic< bool >{ true };
+  auto read = [&]() {
+    reader_count++;
+    auto last = std::uint64_t{ 0 };
+    while ( is_writing )
+    {
+      auto value = lock.load();
+      for ( auto &&w : value )
+      {
+        is_ok = is_ok && w == value[ 0 ];
+      }
+      is_ok = is_ok && value[ 0 ] >= last;
+      last = value[ 0 ];
+    }
+  };
+  auto readers = std::vector< std::thread >{};
+  for ( auto r = 0; r < 3; r++ )
+  {
+    readers.emplace_back( read );
+  }
+
+  // writer publishes for a while once all readers run
+  while ( reader_count < 3 )
+  {
+    std::this_thread::yield();
+  }
+  auto stop =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds( 200 );
+  auto store_count = std::uint64_t{ 0 };
+  while ( std::chrono::steady_clock::now() < stop )
+  {
+    auto value = value_t{};
+    value.fill( ++store_count );
+    lock.store( value );
+  }
+  is_writing = false;
+
+  for ( auto &&t : readers )
+  {
+    t.join();
+  }
+  return is_ok && lock.load()[ 7 ] == store_count &&
+         lock.version() == store_count + 1u;
+}
+
+// exception thrown by any call of parallel_for (on helper or calling
+// thread) reaches caller after all started calls finished, and indices not
+// started by then are skipped
+bool check_parallel_for_exception()
+{
+  auto pool = isai::thread_pool_t{ 3u };
+  auto is_ok = true;
+  for ( auto bad = std::size_t{ 0 }; bad < 64u; bad += 7u )
+  {
+    auto call_count = std::atomic< std::size_t >{ 0u };
+    auto is_thrown = false;
+    try
+    {
+      pool.parallel_for( 64u, [bad, &call_count]( std::size_t i ) {
+        call_count++;
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+        if ( i == bad )
+        {
+          throw std::runtime_error{ "bad index" };
+        }
+      } );
+    }
+    catch ( std::runtime_error const & )
+    {
+      is_thrown = true;
+    }
+    is_ok = is_ok && is_thrown && ( bad > 32u || call_count < 64u );
+  }
+  return is_ok;
+}
+
+// errors computed by genepa worker process on localhost are those of local
+// evaluator, for every metric (worker must stay connected, as coordinator
+// falls back to local evaluation without workers)
+bool check_remote_evaluator()
+{
+  // free port is found by binding to any, then released for worker
+  auto port = std::uint16_t{ 0 };
+  {
+    auto probe = isai::listen_tcp( 0u );
+    auto addr = sockaddr_in{};
+    auto len = socklen_t{ sizeof( addr ) };
+    if ( !probe.is_valid() ||
+         ::getsockname( probe.fd(), reinterpret_cast< sockaddr * >( &addr ),
+                        &len ) != 0 )
+    {
+      return false;
+    }
+    port = ntohs( addr.sin_port );
+  }
+
+  auto port_arg = std::to_string( port );
+  char worker_arg[] = "--worker";
+  char *argv[] = { &s_genepa_path[ 0 ], worker_arg, &port_arg[ 0 ], nullptr };
+  auto actions = posix_spawn_file_actions_t{};
+  posix_spawn_file_actions_init( &actions );
+  posix_spawn_file_actions_addopen( &actions, 1, "/dev/null", O_WRONLY, 0 );
+  auto pid = pid_t{ 0 };
+  auto rc = posix_spawn( &pid, s_genepa_path.c_str(), &actions, nullptr,
+                         argv, environ );
+  posix_spawn_file_actions_destroy( &actions );
+  if ( rc != 0 )
+  {
+    return false;
+  }
+
+  // worker serves one coordinator at a time, so probe connection is closed
+  // before evaluator connects
+  auto is_listening = false;
+  for ( auto n = 0; n < 100 && !is_listening; n++ )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    is_listening = isai::connect_tcp( "127.0.0.1", port ).is_valid();
+  }
+
+  auto tdata = noisy_data( 300u );
+  auto pop = random_population( 500u );
+  auto is_ok = is_listening;
+  for ( auto kind : ALL_METRICS )
+  {
+    if ( !is_ok )
+    {
+      break;
+    }
+    auto settings = isai::dist_settings_t{};
+    settings.endpoints = { "127.0.0.1:" + port_arg };
+    auto remote = isai::remote_evaluator_t< 35 >{ settings, kind, 2.0 };
+    auto local = isai::make_local_evaluator< 35 >( kind, 2.0 );
+    remote.bind( tdata );
+    local->bind( tdata );
+
+    auto remote_errors = std::vector< double >{};
+    auto local_errors = std::vector< double >{};
+    remote.evaluate( pop, remote_errors );
+    local->evaluate( pop, local_errors );
+    is_ok = remote.worker_count() == 1u && remote_errors == local_errors;
+  }
+
+  ::kill( pid, SIGTERM );
+  ::waitpid( pid, nullptr, 0 );
+  return is_ok;
+}
+
+
+int main( int argc, char *argv[] )
+{
+  for ( auto i = 1; i + 1 < argc; i += 2 )
+  {
+    if ( std::string{ argv[ i ] } == "--genepa" )
+    {
+      s_genepa_path = argv[ i + 1 ];
+    }
+  }
+
+  struct check_t
+  {
+    char const *name;
+    bool ( *func )();
+    bool is_genepa_needed;
+  };
+  check_t const checks[] = {
+    { "slice: transpose_bits", check_transpose_bits, false },
+    { "slice: transpose_byte_bits", check_transpose_byte_bits, false },
+    { "slice: decode matches to_polynomial", check_sliced_decode, false },
+    { "slice: breed without mutation matches crossover", check_sliced_breed,
+      false },
+    { "slice: random_mask rate", check_random_mask, false },
+    { "rates: skip-sampled mutation rate per gene",
+      check_skip_sampled_mutation, false },
+    { "progressive: 7-bit grid matches COEFF_TABLE", check_chromosome_grid,
+      false },
+    { "progressive: expand_codes keeps values", check_expand_codes, false },
+    { "metric: kernels match scalar reference", check_metric_kernels, false },
+    { "exact: solver matches exhaustive search", check_exact_solver,
+      false },
+    { "coreset: total weight is preserved", check_coreset_weight, false },
+    { "coreset: errors stay within bound", check_coreset_error_bound,
+      false },
+    { "coreset: failed solution drops coreset", check_coreset_fallback,
+      false },
+    { "shuffle: scatter shuffle is uniform permutation",
+      check_scatter_shuffle, false },
+    { "cache: stored solutions are found after reopening",
+      check_solution_cache, false },
+    { "seqlock: reads never tear", check_seqlock, false },
+    { "pool: parallel_for rethrows exception of call",
+      check_parallel_for_exception, false },
+    { "dist: worker errors match local evaluator", check_remote_evaluator,
+      true },
+  };
+
+  isai::prng_t::seed( 1u );
+  auto is_ok = true;
+  for ( auto &&c : checks )
+  {
+    if ( c.is_genepa_needed && s_genepa_path.empty() )
+    {
+      std::printf( "%-50s %s\n", c.name, "skipped" );
+      continue;
+    }
+    auto is_passed = c.func();
+    std::printf( "%-50s %s\n", c.name, is_passed ? "ok" : "FAILED" );
+    is_ok = is_ok && is_passed;
+  }
+
+  std::printf( is_ok ? "All checks passed.\n" : "Some checks failed.\n" );
+  return is_ok ? 0 : 1;
+}
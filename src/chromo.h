@@ -10,6 +10,8 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 
 namespace isai
 {
@@ -28,6 +30,13 @@ namespace isai
     // default constructor - initializes with randomized values
     chromosome_t() : m_data() { prng_t::fill_with_random_bits( m_data ); }
 
+    // constructor from packed genes (BYTE_COUNT bytes, e.g. received over
+    // network)
+    explicit chromosome_t( byte_t const *bytes_p ) noexcept : m_data()
+    {
+      std::copy( bytes_p, bytes_p + BYTE_COUNT, m_data.begin() );
+    }
+
     // copy/move constructors/assignment
     chromosome_t( chromosome_t const & ) = default;
     chromosome_t( chromosome_t && ) noexcept = default;
@@ -41,6 +50,21 @@ namespace isai
       return m_data[ pos >> 3u ] & ( 1u << ( pos & 0x7u ) );
     }
 
+    // sets value of gene at given position
+    void set_gene( std::size_t pos, bool value )
+    {
+      assert( pos < gene_count() );
+      auto bit = static_cast< byte_t >( 1u << ( pos & 0x7u ) );
+      if ( value )
+      {
+        m_data[ pos >> 3u ] |= bit;
+      }
+      else
+      {
+        m_data[ pos >> 3u ] &= static_cast< byte_t >( ~bit );
+      }
+    }
+
     // flips value of gene at given position
     void flip_gene( std::size_t pos )
     {
@@ -105,76 +129,150 @@ namespace isai
     std::array< byte_t, BYTE_COUNT > m_data;
   };
 
+  // type alias for population of n-gene chromosomes
+  template < std::size_t N >
+  using population_t = std::vector< chromosome_t< N > >;
+
+  // number of genes that differ between given chromosomes (popcount of xor
+  // over genes packed into 64-bit words; unused bits of last byte are ignored)
+  template < std::size_t N >
+  std::size_t hamming_distance( chromosome_t< N > const &lhs,
+                                chromosome_t< N > const &rhs ) noexcept
+  {
+    constexpr auto word_count = ( chromosome_t< N >::BYTE_COUNT + 7u ) / 8u;
+    std::uint64_t lw[ word_count ] = {};
+    std::uint64_t rw[ word_count ] = {};
+    std::memcpy( lw, &*lhs.begin(), chromosome_t< N >::BYTE_COUNT );
+    std::memcpy( rw, &*rhs.begin(), chromosome_t< N >::BYTE_COUNT );
+
+    // genes are stored from least significant bit of first byte, so valid
+    // genes of little-endian word are its lowest bits
+    constexpr auto tail_bits = N % 64u;
+    if ( tail_bits != 0 )
+    {
+      auto tail_mask = ( std::uint64_t{ 1 } << tail_bits ) - 1u;
+      lw[ word_count - 1u ] &= tail_mask;
+      rw[ word_count - 1u ] &= tail_mask;
+    }
+
+    auto res = std::size_t{ 0 };
+    for ( auto i = std::size_t{ 0 }; i < word_count; i++ )
+    {
+      res += static_cast< std::size_t >(
+        __builtin_popcountll( lw[ i ] ^ rw[ i ] ) );
+    }
+    return res;
+  }
+
+
   /*-------------------*/
   /*     CONVERTERS    */
   /*-------------------*/
 
 
+  // value of coefficient encoded by 7 genes (bit 0 of given code - sign,
+  // bits 1 .. 6 - magnitude in quarters, most significant first)
+  constexpr double decode_coeff( unsigned code ) noexcept
+  {
+    auto quarters = 0u;
+    for ( auto b = 1u; b < 7u; b++ )
+    {
+      quarters = 2u * quarters + ( ( code >> b ) & 1u );
+    }
+    auto magnitude = 0.25 * quarters;
+    return ( code & 1u ) != 0u ? -magnitude : magnitude;
+  }
+
+  constexpr std::array< double, 128 > make_coeff_table() noexcept
+  {
+    auto res = std::array< double, 128 >{};
+    for ( auto code = 0u; code < 128u; code++ )
+    {
+      res[ code ] = decode_coeff( code );
+    }
+    return res;
+  }
+
+  // values of all coefficient codes
+  constexpr const std::array< double, 128 > COEFF_TABLE = make_coeff_table();
+
+  // genes of given chromosome packed into single word (gene i at bit i)
+  template < std::size_t N >
+  std::uint64_t to_word( chromosome_t< N > const &chromo ) noexcept
+  {
+    static_assert( N < 64u, "chromosome does not fit in single word" );
+    auto res = std::uint64_t{ 0 };
+    std::memcpy( &res, &*chromo.begin(), chromosome_t< N >::BYTE_COUNT );
+    return res;
+  }
+
+  // chromosome of genes packed into given word - inverse of to_word
+  template < std::size_t N >
+  chromosome_t< N > from_word( std::uint64_t word ) noexcept
+  {
+    static_assert( N < 64u, "chromosome does not fit in single word" );
+    byte_t bytes[ sizeof( word ) ];
+    std::memcpy( bytes, &word, sizeof( word ) );
+    return chromosome_t< N >{ bytes };
+  }
+
   // converterts given chromosome to polynomial object that it represents
+  // (7-bit codes of coefficients are looked up in table)
   template < std::size_t N >
   auto to_polynomial( chromosome_t< N > const &chromo )
   {
-    auto tmp = std::array< byte_t, chromosome_t< N >::BYTE_COUNT >{};
-    std::copy( chromo.begin(), chromo.end(), tmp.begin() );
+    auto word = to_word( chromo );
     double coeffs[ N / 7u ];
 
     for ( auto i = std::size_t{ 0 }; i < N / 7u; i++ )
     {
-      auto pos = i * 7u;
-      coeffs[ i ] = 0.0;
-      if ( chromo[ pos + 1 ] )
-      {
-        coeffs[ i ] += 8.0;
-      }
-      if ( chromo[ pos + 2 ] )
-      {
-        coeffs[ i ] += 4.0;
-      }
-      if ( chromo[ pos + 3 ] )
-      {
-        coeffs[ i ] += 2.0;
-      }
-      if ( chromo[ pos + 4 ] )
-      {
-        coeffs[ i ] += 1.0;
-      }
-      if ( chromo[ pos + 5 ] )
-      {
-        coeffs[ i ] += 0.5;
-      }
-      if ( chromo[ pos + 6 ] )
+      coeffs[ i ] = COEFF_TABLE[ ( word >> ( i * 7u ) ) & 0x7fu ];
+    }
+
+    return polynomial_t< ( N / 7u ) - 1u >{ coeffs };
+  }
+
+  // rounds given coefficients to values representable by chromosomes
+  // (multiples of 0.25 within [ -15.75, 15.75 ])
+  inline void normalize_coeffs( std::vector< double > &coeffs )
+  {
+    for ( auto &&c : coeffs )
+    {
+      c = std::round( c * 4.0 ) / 4.0;
+      if ( c < -15.75 )
       {
-        coeffs[ i ] += 0.25;
+        c = -15.75;
       }
-      if ( chromo[ pos ] )
+      else if ( c > 15.75 )
       {
-        coeffs[ i ] *= -1.0;
+        c = 15.75;
       }
     }
-
-    return polynomial_t< ( N / 7u ) - 1u >{ coeffs };
   }
 
-
-  /*-------------------------*/
-  /*     ERROR EVALUATION    */
-  /*-------------------------*/
-
-  // evaluates average linear error of polynomial represented by given
-  // chromosome with respect to given training data points
+  // converts given coefficients (a_0 first, N / 7 of them, already
+  // normalized) to chromosome representing them - inverse of to_polynomial
   template < std::size_t N >
-  double eval_error( chromosome_t< N > const &chromo,
-                     training_data_t const &td )
+  chromosome_t< N > from_coeffs( std::vector< double > const &coeffs )
   {
-    auto poly = to_polynomial( chromo );
-    auto res = double{ 0.0 };
-    for ( auto &&dp : td )
+    assert( coeffs.size() == N / 7u );
+    auto res = chromosome_t< N >{};
+
+    for ( auto i = std::size_t{ 0 }; i < N / 7u; i++ )
     {
-      auto diff = dp.y - poly( dp.x );
-      // res += ( diff * diff );
-      res += std::abs( diff );
+      auto pos = i * 7u;
+      auto quarters =
+        static_cast< unsigned >( std::lround( std::abs( coeffs[ i ] ) * 4.0 ) );
+      assert( quarters < 64u );
+
+      res.set_gene( pos, coeffs[ i ] < 0.0 );
+      for ( auto b = std::size_t{ 1 }; b < 7u; b++ )
+      {
+        res.set_gene( pos + b, ( quarters >> ( 6u - b ) ) & 1u );
+      }
     }
-    return res / static_cast< double >( td.size() );
+
+    return res;
   }
 
 }  // namespace isai
@@ -0,0 +1,544 @@
+#include "config.h"
+#include "progressive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace isai
+{
+
+  namespace
+  {
+    // removes leading and trailing whitespace
+    std::string trim( std::string const &str )
+    {
+      auto first = str.find_first_not_of( " \t\r" );
+      if ( first == std::string::npos )
+      {
+        return std::string{};
+      }
+      auto last = str.find_last_not_of( " \t\r" );
+      return str.substr( first, last - first + 1 );
+    }
+
+    // textual value of given setting (as read by apply_setting)
+    template < typename T >
+    std::string to_text( T const &value )
+    {
+      auto out = std::ostringstream{};
+      out.precision( 10 );
+      out << value;
+      return out.str();
+    }
+
+    std::string to_text( bool value ) { return value ? "true" : "false"; }
+
+    std::string to_text( solver_kind_t kind )
+    {
+      switch ( kind )
+      {
+      case solver_kind_t::de:
+        return "de";
+      case solver_kind_t::exact:
+        return "exact";
+      case solver_kind_t::streaming:
+        return "streaming";
+      case solver_kind_t::progressive:
+        return "progressive";
+      case solver_kind_t::genetic:
+      default:
+        return "genetic";
+      }
+    }
+
+    std::string to_text( metric_kind_t kind )
+    {
+      switch ( kind )
+      {
+      case metric_kind_t::l2:
+        return "l2";
+      case metric_kind_t::linf:
+        return "linf";
+      case metric_kind_t::huber:
+        return "huber";
+      case metric_kind_t::l1:
+      default:
+        return "l1";
+      }
+    }
+  }  // namespace
+
+  bool split_setting_line( std::string const &line, std::string &label,
+                           std::string &value )
+  {
+    auto colon = line.find( ':' );
+    if ( colon == std::string::npos )
+    {
+      return false;
+    }
+
+    label = trim( line.substr( 0, colon ) );
+    value = trim( line.substr( colon + 1 ) );
+    return !label.empty();
+  }
+
+  bool apply_setting( std::string const &label, std::string const &text,
+                      ga_settings_t &s )
+  {
+    double dbl;
+    std::string str;
+    std::size_t szt;
+
+    auto value = std::istringstream{ text };
+
+    if ( label == "random input" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.is_input_random = str == "true";
+    }
+    else if ( label == "analytic error" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.is_error_analytic = str == "true";
+    }
+    else if ( label == "input coefficients" )
+    {
+      s.input_coeffs.clear();
+      for ( auto i = std::size_t{ 0 }; i < 5u; i++ )
+      {
+        if ( !( value >> dbl ) )
+        {
+          return false;
+        }
+        s.input_coeffs.emplace_back( dbl );
+      }
+    }
+    else if ( label == "population size" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.pop_size = szt;
+    }
+    else if ( label == "thread count" )
+    {
+      if ( !( value >> szt ) )
+      {
+        return false;
+      }
+      s.thread_count = szt;
+    }
+    else if ( label == "maximum generations" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.max_gens = szt;
+    }
+    else if ( label == "training data size" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.training_data_size = szt;
+    }
+    else if ( label == "error threshold" )
+    {
+      if ( !( value >> dbl ) || dbl <= 0.0 )
+      {
+        return false;
+      }
+      s.error_threshold = dbl;
+    }
+    else if ( label == "base mutation rate" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.base_mutation_rate = dbl;
+    }
+    else if ( label == "mutation rate growth threshold" )
+    {
+      if ( !( value >> szt ) )
+      {
+        return false;
+      }
+      s.mutation_rate_growth_threshold = szt;
+    }
+    else if ( label == "mutation rate growth coeff" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 )
+      {
+        return false;
+      }
+      s.mutation_rate_growth_coeff = dbl;
+    }
+    else if ( label == "population reset threshold" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.pop_reset_threshold = szt;
+    }
+    else if ( label == "restart policy" )
+    {
+      if ( !( value >> str ) || ( str != "full" && str != "partial" ) )
+      {
+        return false;
+      }
+      s.restart_policy = str == "full" ? restart_policy_t::full
+                                       : restart_policy_t::partial;
+    }
+    else if ( label == "error metric" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      if ( str == "l1" )
+      {
+        s.error_metric = metric_kind_t::l1;
+      }
+      else if ( str == "l2" )
+      {
+        s.error_metric = metric_kind_t::l2;
+      }
+      else if ( str == "linf" )
+      {
+        s.error_metric = metric_kind_t::linf;
+      }
+      else if ( str == "huber" )
+      {
+        s.error_metric = metric_kind_t::huber;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    else if ( label == "huber delta" )
+    {
+      if ( !( value >> dbl ) || dbl <= 0.0 )
+      {
+        return false;
+      }
+      s.huber_delta = dbl;
+    }
+    else if ( label == "solver" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      if ( str == "genetic" )
+      {
+        s.solver = solver_kind_t::genetic;
+      }
+      else if ( str == "de" )
+      {
+        s.solver = solver_kind_t::de;
+      }
+      else if ( str == "exact" )
+      {
+        s.solver = solver_kind_t::exact;
+      }
+      else if ( str == "streaming" )
+      {
+        s.solver = solver_kind_t::streaming;
+      }
+      else if ( str == "progressive" )
+      {
+        s.solver = solver_kind_t::progressive;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    else if ( label == "solution cache" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.solution_cache_path = str == "none" ? std::string{} : str;
+    }
+    else if ( label == "cache seed fraction" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.cache_seed_fraction = dbl;
+    }
+    else if ( label == "cache match tolerance" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 )
+      {
+        return false;
+      }
+      s.cache_match_tolerance = dbl;
+    }
+    else if ( label == "stream directory" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.stream_directory = str;
+    }
+    else if ( label == "stream chunk size" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.stream_chunk_size = szt;
+    }
+    else if ( label == "exact node limit" )
+    {
+      if ( !( value >> szt ) )
+      {
+        return false;
+      }
+      s.exact_node_limit = szt;
+    }
+    else if ( label == "precision stages" )
+    {
+      s.precision_stages.clear();
+      while ( value >> szt )
+      {
+        if ( szt < MIN_CODE_BITS || szt > MAX_CODE_BITS ||
+             ( !s.precision_stages.empty() &&
+               szt <= s.precision_stages.back() ) )
+        {
+          return false;
+        }
+        s.precision_stages.push_back( szt );
+      }
+      if ( s.precision_stages.empty() )
+      {
+        return false;
+      }
+    }
+    else if ( label == "stage stall generations" )
+    {
+      if ( !( value >> szt ) || szt == 0 )
+      {
+        return false;
+      }
+      s.stage_stall_threshold = szt;
+    }
+    else if ( label == "certify result" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.is_result_certified = str == "true";
+    }
+    else if ( label == "bit sliced population" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.is_population_bit_sliced = str == "true";
+    }
+    else if ( label == "adaptive gene rates" )
+    {
+      if ( !( value >> str ) )
+      {
+        return false;
+      }
+      s.is_gene_rate_adaptive = str == "true";
+    }
+    else if ( label == "coreset size" )
+    {
+      if ( !( value >> szt ) )
+      {
+        return false;
+      }
+      s.coreset_size = szt;
+    }
+    else if ( label == "coreset error bound" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl >= 1.0 )
+      {
+        return false;
+      }
+      s.coreset_error_bound = dbl;
+    }
+    else if ( label == "order search degree" )
+    {
+      if ( !( value >> szt ) || szt > 4u )
+      {
+        return false;
+      }
+      s.order_search_degree = szt;
+    }
+    else if ( label == "de weight" )
+    {
+      if ( !( value >> dbl ) || dbl <= 0.0 || dbl > 2.0 )
+      {
+        return false;
+      }
+      s.de_weight = dbl;
+    }
+    else if ( label == "de crossover rate" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.de_crossover_rate = dbl;
+    }
+    else if ( label == "warm start fraction" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.warm_start_fraction = dbl;
+    }
+    else if ( label == "diversity collapse threshold" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.diversity_collapse_threshold = dbl;
+    }
+    else if ( label == "restart elite count" )
+    {
+      if ( !( value >> szt ) )
+      {
+        return false;
+      }
+      s.restart_elite_count = szt;
+    }
+    else if ( label == "restart reseed fraction" )
+    {
+      if ( !( value >> dbl ) || dbl < 0.0 || dbl > 1.0 )
+      {
+        return false;
+      }
+      s.restart_reseed_fraction = dbl;
+    }
+    else
+    {
+      return false;
+    }
+    return true;
+  }
+
+  bool load_settings( std::string const &path, ga_settings_t &s )
+  {
+    auto fin = std::ifstream{ path, std::ios::in };
+    if ( !fin )
+    {
+      return false;
+    }
+
+    auto line = std::string{};
+    auto label = std::string{};
+    auto value = std::string{};
+    while ( std::getline( fin, line ) )
+    {
+      if ( split_setting_line( line, label, value ) &&
+           !apply_setting( label, value, s ) )
+      {
+        std::printf( "Unknown or invalid setting \"%s\" ignored.\n",
+                     label.c_str() );
+      }
+    }
+    return true;
+  }
+
+  bool save_settings( std::string const &path, ga_settings_t const &s )
+  {
+    auto fout = std::ofstream{ path, std::ios::out | std::ios::trunc };
+    if ( !fout )
+    {
+      return false;
+    }
+
+    auto put = [&fout]( char const *label, std::string const &value ) {
+      auto line = std::string{ label } + ":";
+      line.resize( std::max< std::size_t >( line.size() + 1u, 32u ), ' ' );
+      fout << line << value << '\n';
+    };
+
+    auto coeffs = std::string{};
+    for ( auto &&c : s.input_coeffs )
+    {
+      coeffs += ( coeffs.empty() ? "" : " " ) + to_text( c );
+    }
+    auto stages = std::string{};
+    for ( auto &&bits : s.precision_stages )
+    {
+      stages += ( stages.empty() ? "" : " " ) + to_text( bits );
+    }
+
+    put( "random input", to_text( s.is_input_random ) );
+    put( "input coefficients", coeffs );
+    fout << '\n';
+    put( "population size", to_text( s.pop_size ) );
+    put( "maximum generations", to_text( s.max_gens ) );
+    put( "training data size", to_text( s.training_data_size ) );
+    put( "error threshold", to_text( s.error_threshold ) );
+    put( "base mutation rate", to_text( s.base_mutation_rate ) );
+    put( "adaptive gene rates", to_text( s.is_gene_rate_adaptive ) );
+    put( "thread count", to_text( s.thread_count ) );
+    put( "bit sliced population", to_text( s.is_population_bit_sliced ) );
+    put( "error metric", to_text( s.error_metric ) );
+    put( "huber delta", to_text( s.huber_delta ) );
+    put( "warm start fraction", to_text( s.warm_start_fraction ) );
+    put( "coreset size", to_text( s.coreset_size ) );
+    put( "coreset error bound", to_text( s.coreset_error_bound ) );
+    put( "analytic error", to_text( s.is_error_analytic ) );
+    put( "solver", to_text( s.solver ) );
+    put( "de weight", to_text( s.de_weight ) );
+    put( "de crossover rate", to_text( s.de_crossover_rate ) );
+    put( "exact node limit", to_text( s.exact_node_limit ) );
+    put( "precision stages", stages );
+    put( "stage stall generations", to_text( s.stage_stall_threshold ) );
+    put( "order search degree", to_text( s.order_search_degree ) );
+    put( "stream directory", s.stream_directory );
+    put( "stream chunk size", to_text( s.stream_chunk_size ) );
+    put( "certify result", to_text( s.is_result_certified ) );
+    put( "solution cache", s.solution_cache_path.empty()
+                             ? std::string{ "none" }
+                             : s.solution_cache_path );
+    put( "cache seed fraction", to_text( s.cache_seed_fraction ) );
+    put( "cache match tolerance", to_text( s.cache_match_tolerance ) );
+    fout << '\n';
+    put( "mutation rate growth threshold",
+         to_text( s.mutation_rate_growth_threshold ) );
+    put( "mutation rate growth coeff",
+         to_text( s.mutation_rate_growth_coeff ) );
+    put( "population reset threshold", to_text( s.pop_reset_threshold ) );
+    fout << '\n';
+    put( "restart policy",
+         s.restart_policy == restart_policy_t::full ? "full" : "partial" );
+    put( "diversity collapse threshold",
+         to_text( s.diversity_collapse_threshold ) );
+    put( "restart elite count", to_text( s.restart_elite_count ) );
+    put( "restart reseed fraction", to_text( s.restart_reseed_fraction ) );
+    return static_cast< bool >( fout );
+  }
+
+}  // namespace isai
@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_CONFIG_H_INCLUDED
+#define ISAI_GENEPI_CONFIG_H_INCLUDED
+
+#include "alg.h"
+
+#include <string>
+
+namespace isai
+{
+
+  // splits config line of form "label: value(s)"; returns false if line
+  // does not hold any setting
+  bool split_setting_line( std::string const &line, std::string &label,
+                           std::string &value );
+
+  // applies setting with given label (as used in config file) and textual
+  // value; returns false if label is unknown or value is invalid
+  bool apply_setting( std::string const &label, std::string const &value,
+                      ga_settings_t &s );
+
+  // loads settings from config file at given path - every line has form
+  // "label: value(s)", lines may be given in any order and missing ones keep
+  // their current values; returns false if file cannot be opened
+  bool load_settings( std::string const &path, ga_settings_t &s );
+
+  // writes all settings to config file at given path (in format read by
+  // load_settings); returns false if file cannot be written
+  bool save_settings( std::string const &path, ga_settings_t const &s );
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_CONFIG_H_INCLUDED
@@ -0,0 +1 @@
+#include "coreset.h"
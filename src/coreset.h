@@ -0,0 +1,174 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_CORESET_H_INCLUDED
+#define ISAI_GENEPI_CORESET_H_INCLUDED
+
+#include "poly.h"
+#include "prng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace isai
+{
+
+  // probability that coreset of size given by coreset_size_for_error misses
+  // its error bound
+  constexpr const double CORESET_FAILURE_PROB = 0.05;
+
+  // number of points of coreset that preserves weighted error of every
+  // polynomial with given number of coefficients within relative error bound
+  // (with probability 1 - CORESET_FAILURE_PROB) - sensitivity sampling bound
+  // s * ln( s / p ) / eps^2, where total sensitivity s is coefficient count
+  // plus one
+  inline std::size_t coreset_size_for_error( double error_bound,
+                                             std::size_t coeff_count )
+  {
+    if ( !( error_bound > 0.0 ) )
+    {
+      return 0u;
+    }
+    auto s = static_cast< double >( coeff_count + 1u );
+    auto size = s * std::log( s / CORESET_FAILURE_PROB ) /
+                ( error_bound * error_bound );
+    return static_cast< std::size_t >( std::ceil( size ) );
+  }
+
+  // compresses given training data to weighted coreset of (at most) given
+  // number of points - sensitivity sampling: sensitivity of point is its
+  // statistical leverage in weighted vandermonde matrix (arguments scaled to
+  // [ -1, 1 ]) plus its share of total weight, points are drawn by systematic
+  // sampling proportionally to it and weighted by inverse of their inclusion
+  // rate (then rescaled to total weight of data, so that weighted means are
+  // unbiased); leverage bounds influence of point on least squares fit
+  // exactly and on l1 / huber fits up to factor of coefficient count; returns
+  // false (leaving result untouched) if vandermonde matrix is singular
+  inline bool build_coreset( training_data_t const &td, std::size_t coeff_count,
+                             std::size_t size, training_data_t &res )
+  {
+    auto scale = double{ 0.0 };
+    auto weight_sum = double{ 0.0 };
+    for ( auto &&dp : td )
+    {
+      scale = std::max( scale, std::abs( dp.x ) );
+      weight_sum += dp.w;
+    }
+    if ( scale == 0.0 )
+    {
+      scale = 1.0;
+    }
+    if ( size == 0u || !( weight_sum > 0.0 ) )
+    {
+      return false;
+    }
+
+    auto powers = [scale, coeff_count]( double x, double *powers_p ) {
+      auto t = x / scale;
+      powers_p[ 0 ] = 1.0;
+      for ( auto k = std::size_t{ 1 }; k < coeff_count; k++ )
+      {
+        powers_p[ k ] = powers_p[ k - 1u ] * t;
+      }
+    };
+
+    // gram matrix V^T W V
+    auto gram = std::vector< double >( coeff_count * coeff_count, 0.0 );
+    auto row = std::vector< double >( coeff_count );
+    for ( auto &&dp : td )
+    {
+      powers( dp.x, row.data() );
+      for ( auto r = std::size_t{ 0 }; r < coeff_count; r++ )
+      {
+        for ( auto c = std::size_t{ 0 }; c <= r; c++ )
+        {
+          gram[ r * coeff_count + c ] += dp.w * row[ r ] * row[ c ];
+        }
+      }
+    }
+
+    // its cholesky factor (lower triangle, in place)
+    auto tiny = 1e-12 * gram[ 0 ];
+    for ( auto c = std::size_t{ 0 }; c < coeff_count; c++ )
+    {
+      auto diag = gram[ c * coeff_count + c ];
+      for ( auto k = std::size_t{ 0 }; k < c; k++ )
+      {
+        diag -= gram[ c * coeff_count + k ] * gram[ c * coeff_count + k ];
+      }
+      if ( !( diag > tiny ) )
+      {
+        return false;
+      }
+      diag = std::sqrt( diag );
+      gram[ c * coeff_count + c ] = diag;
+      for ( auto r = c + 1u; r < coeff_count; r++ )
+      {
+        auto val = gram[ r * coeff_count + c ];
+        for ( auto k = std::size_t{ 0 }; k < c; k++ )
+        {
+          val -= gram[ r * coeff_count + k ] * gram[ c * coeff_count + k ];
+        }
+        gram[ r * coeff_count + c ] = val / diag;
+      }
+    }
+
+    // sensitivities: w_i * | L^-1 v_i |^2 + w_i / W (sum to coeff_count + 1)
+    auto sens = std::vector< double >( td.size() );
+    auto total = double{ 0.0 };
+    for ( auto i = std::size_t{ 0 }; i < td.size(); i++ )
+    {
+      powers( td[ i ].x, row.data() );
+      auto leverage = double{ 0.0 };
+      for ( auto r = std::size_t{ 0 }; r < coeff_count; r++ )
+      {
+        auto val = row[ r ];
+        for ( auto k = std::size_t{ 0 }; k < r; k++ )
+        {
+          val -= gram[ r * coeff_count + k ] * row[ k ];
+        }
+        row[ r ] = val / gram[ r * coeff_count + r ];
+        leverage += row[ r ] * row[ r ];
+      }
+      sens[ i ] = td[ i ].w * ( leverage + 1.0 / weight_sum );
+      total += sens[ i ];
+    }
+
+    // systematic sampling - size equally spaced positions (random offset)
+    // over cumulative sensitivities; point hit c times gets weight
+    // c * w_i / ( size * p_i )
+    auto m = static_cast< double >( size );
+    auto step = total / m;
+    auto pos = std::min( prng_t::get_fraction(), 0.999999 ) * step;
+    auto cumulative = double{ 0.0 };
+    auto coreset = training_data_t{};
+    auto coreset_weight = double{ 0.0 };
+    for ( auto i = std::size_t{ 0 }; i < td.size() && pos < total; i++ )
+    {
+      cumulative += sens[ i ];
+      auto hits = std::size_t{ 0 };
+      while ( pos < cumulative && pos < total )
+      {
+        hits++;
+        pos += step;
+      }
+      if ( hits != 0u )
+      {
+        auto w = static_cast< double >( hits ) * td[ i ].w * total /
+                 ( m * sens[ i ] );
+        coreset.push_back( data_point_t{ td[ i ].x, td[ i ].y, w } );
+        coreset_weight += w;
+      }
+    }
+
+    for ( auto &&dp : coreset )
+    {
+      dp.w *= weight_sum / coreset_weight;
+    }
+    res.swap( coreset );
+    return true;
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_CORESET_H_INCLUDED
@@ -0,0 +1,506 @@
+#include "daemon.h"
+
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <thread>
+
+namespace isai
+{
+
+  bool daemon_client_t::send_line( std::string const &line )
+  {
+    auto lock = std::unique_lock< std::mutex >{ m_send_mutex };
+    return send_all( m_sock, line.data(), line.size() ) &&
+           send_all( m_sock, "\n", 1u );
+  }
+
+  namespace
+  {
+    // formats response line printf-style
+    template < typename... Args >
+    std::string format_line( char const *fmt, Args... args )
+    {
+      char buffer[ 512 ];
+      std::snprintf( buffer, sizeof( buffer ), fmt, args... );
+      return std::string{ buffer };
+    }
+
+    // splits command line into command word and its argument
+    void split_command( std::string const &line, std::string &cmd,
+                        std::string &arg )
+    {
+      auto space = line.find( ' ' );
+      cmd = line.substr( 0, space );
+      arg = space == std::string::npos ? std::string{}
+                                       : line.substr( space + 1 );
+    }
+
+    // message of given exception
+    std::string describe( std::exception_ptr error )
+    {
+      try
+      {
+        std::rethrow_exception( std::move( error ) );
+      }
+      catch ( std::exception const &e )
+      {
+        return e.what();
+      }
+      catch ( ... )
+      {
+        return "unknown error";
+      }
+    }
+
+    // name of setting that job asks for but daemon does not honour (it only
+    // runs genetic algorithm on data sent with job); empty if there is none
+    std::string unsupported_setting( ga_settings_t const &s )
+    {
+      if ( s.solver != solver_kind_t::genetic )
+      {
+        return "solver";
+      }
+      if ( s.order_search_degree != 0u )
+      {
+        return "order search degree";
+      }
+      if ( s.is_error_analytic )
+      {
+        return "analytic error";
+      }
+      if ( s.is_result_certified )
+      {
+        return "certify result";
+      }
+      if ( !s.solution_cache_path.empty() )
+      {
+        return "solution cache";
+      }
+      if ( !s.is_input_random || !s.input_coeffs.empty() )
+      {
+        return "input coefficients";
+      }
+      return std::string{};
+    }
+  }  // namespace
+
+  fit_daemon_t::fit_daemon_t( std::string socket_path,
+                              std::size_t thread_count,
+                              ga_settings_t defaults ) :
+    m_socket_path( std::move( socket_path ) ),
+    m_defaults( std::move( defaults ) ),
+    m_pool( thread_count )
+  {
+    m_defaults.thread_count = 1u;
+    m_defaults.is_verbose = false;
+    m_defaults.is_quiet = true;
+    m_defaults.is_file_output_enabled = false;
+
+    // driver-level features of config file do not apply to jobs (only ones
+    // asking for them explicitly are rejected)
+    m_defaults.solver = solver_kind_t::genetic;
+    m_defaults.order_search_degree = 0u;
+    m_defaults.is_error_analytic = false;
+    m_defaults.is_result_certified = false;
+    m_defaults.solution_cache_path.clear();
+    m_defaults.is_input_random = true;
+    m_defaults.input_coeffs.clear();
+    m_defaults.pop_size = std::min( m_defaults.pop_size, MAX_JOB_POP_SIZE );
+
+    // arenas are sized for default settings; jobs only reallocate them if
+    // they ask for larger population
+    auto placeholder = training_data_t{ data_point_t{ 0.0, 0.0 } };
+    m_arenas.reserve( m_pool.thread_count() );
+    for ( auto i = std::size_t{ 0 }; i < m_pool.thread_count(); i++ )
+    {
+      m_arenas.emplace_back( std::make_unique< genetic_algorithm_t< 35 > >(
+        m_defaults, placeholder ) );
+    }
+  }
+
+  int fit_daemon_t::run()
+  {
+    auto listener = listen_unix( m_socket_path );
+    if ( !listener.is_valid() )
+    {
+      std::printf( "Cannot listen at %s\n", m_socket_path.c_str() );
+      return 1;
+    }
+    std::printf( "Daemon listening at %s (%lu workers)\n",
+                 m_socket_path.c_str(), m_pool.thread_count() );
+
+    while ( true )
+    {
+      auto sock = accept_unix( listener );
+      if ( !sock.is_valid() )
+      {
+        continue;
+      }
+
+      auto client = std::make_shared< daemon_client_t >( std::move( sock ) );
+      std::thread{ [this, client]() { serve_client( client ); } }.detach();
+    }
+  }
+
+  /*-----------------------*/
+  /*     HELPER METHODS    */
+  /*-----------------------*/
+
+  void fit_daemon_t::serve_client( std::shared_ptr< daemon_client_t > client )
+  {
+    auto reader = line_reader_t{ client->socket() };
+    auto line = std::string{};
+    auto cmd = std::string{};
+    auto arg = std::string{};
+
+    while ( reader.read_line( line ) )
+    {
+      split_command( line, cmd, arg );
+      if ( cmd == "JOB" )
+      {
+        auto job = std::make_shared< fit_job_t >();
+        job->id = arg.empty() ? std::string{ "-" } : arg;
+        job->settings = m_defaults;
+        job->client = client;
+
+        auto error = std::string{};
+        try
+        {
+          error = read_job( reader, *job );
+        }
+        catch ( ... )
+        {
+          error = "cannot read job: " + describe( std::current_exception() );
+        }
+        if ( !error.empty() )
+        {
+          client->send_line( "ERROR " + job->id + " " + error );
+          continue;
+        }
+        submit( std::move( job ) );
+      }
+      else if ( cmd == "CANCEL" )
+      {
+        cancel( arg, client.get() );
+      }
+      else if ( cmd == "PEEK" )
+      {
+        peek( arg, *client );
+      }
+      else if ( cmd == "PING" )
+      {
+        client->send_line( "PONG" );
+      }
+      else if ( !cmd.empty() )
+      {
+        client->send_line( "ERROR - unknown command: " + cmd );
+      }
+    }
+
+    // client is gone - its jobs are not needed anymore
+    cancel( std::string{}, client.get() );
+  }
+
+  std::string fit_daemon_t::read_job( line_reader_t &reader, fit_job_t &job )
+  {
+    auto line = std::string{};
+    auto label = std::string{};
+    auto value = std::string{};
+    auto error = std::string{};
+
+    while ( reader.read_line( line ) )
+    {
+      if ( line == "END" )
+      {
+        auto weight_sum = double{ 0.0 };
+        for ( auto &&dp : job.tdata )
+        {
+          weight_sum += dp.w;
+        }
+        if ( error.empty() && !( weight_sum > 0.0 ) )
+        {
+          error = "no training data";
+        }
+        if ( error.empty() && job.settings.pop_size < 2u )
+        {
+          error = "population too small";
+        }
+        if ( error.empty() && job.settings.pop_size > MAX_JOB_POP_SIZE )
+        {
+          error = "population too large";
+        }
+        if ( error.empty() )
+        {
+          auto unsupported = unsupported_setting( job.settings );
+          if ( !unsupported.empty() )
+          {
+            error = "setting not supported by daemon: " + unsupported;
+          }
+        }
+        return error;
+      }
+
+      if ( line.compare( 0, 5, "DATA " ) == 0 )
+      {
+        auto count = std::strtoul( line.c_str() + 5, nullptr, 10 );
+        if ( count > MAX_JOB_DATA_SIZE )
+        {
+          // data lines that follow are skipped as invalid ones until END
+          if ( error.empty() )
+          {
+            error = "too many data points";
+          }
+          continue;
+        }
+        job.tdata.clear();
+        job.tdata.reserve( count );
+        for ( auto i = std::size_t{ 0 }; i < count; i++ )
+        {
+          if ( !reader.read_line( line ) )
+          {
+            return "connection lost";
+          }
+          // weight is optional
+          auto point = data_point_t{};
+          auto in = std::istringstream{ line };
+          auto is_valid = static_cast< bool >( in >> point.x >> point.y );
+          if ( is_valid && !( in >> point.w ) )
+          {
+            point.w = in.eof() ? 1.0 : -1.0;
+          }
+          if ( ( !is_valid || point.w < 0.0 ) && error.empty() )
+          {
+            error = "invalid data point: " + line;
+          }
+          job.tdata.push_back( point );
+        }
+        continue;
+      }
+
+      if ( !split_setting_line( line, label, value ) )
+      {
+        if ( error.empty() && !line.empty() )
+        {
+          error = "invalid line: " + line;
+        }
+        continue;
+      }
+
+      if ( label == "time budget ms" )
+      {
+        job.time_budget_ms = std::strtoul( value.c_str(), nullptr, 10 );
+      }
+      else if ( label == "progress interval" )
+      {
+        job.progress_interval = std::strtoul( value.c_str(), nullptr, 10 );
+      }
+      else if ( label == "seed" )
+      {
+        job.seed = std::strtoull( value.c_str(), nullptr, 10 );
+      }
+      else if ( !apply_setting( label, value, job.settings ) && error.empty() )
+      {
+        error = "unknown or invalid setting: " + label;
+      }
+    }
+    return "connection lost";
+  }
+
+  void fit_daemon_t::submit( std::shared_ptr< fit_job_t > job )
+  {
+    // jobs always run silently and single-threaded (daemon parallelizes
+    // across jobs), whatever client asked for
+    job->settings.thread_count = 1u;
+    job->settings.is_verbose = false;
+    job->settings.is_quiet = true;
+    job->settings.is_file_output_enabled = false;
+
+    // lock is held until QUEUED response is sent, so that it precedes any
+    // response sent by worker (which takes the same lock on start)
+    auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+    m_jobs.emplace( job->id, job );
+
+    auto client = job->client;
+    auto id = job->id;
+    auto position =
+      m_pool.submit( [this, job = std::move( job )]() { execute( *job ); } );
+    client->send_line( format_line( "QUEUED %s %lu", id.c_str(), position ) );
+  }
+
+  void fit_daemon_t::cancel( std::string const &id,
+                             daemon_client_t const *client_p )
+  {
+    auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+    for ( auto it = std::begin( m_jobs ); it != std::end( m_jobs ); )
+    {
+      auto job = it->second.lock();
+      if ( !job )
+      {
+        it = m_jobs.erase( it );
+        continue;
+      }
+      if ( ( id.empty() || it->first == id ) &&
+           ( client_p == nullptr || job->client.get() == client_p ) )
+      {
+        job->is_cancelled = true;
+        if ( job->solver_p != nullptr )
+        {
+          job->solver_p->cancel();
+        }
+      }
+      ++it;
+    }
+  }
+
+  void fit_daemon_t::peek( std::string const &id, daemon_client_t &client )
+  {
+    auto snap = solver_snapshot_t{};
+    auto is_running = false;
+    {
+      auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+      auto range = m_jobs.equal_range( id );
+      for ( auto it = range.first; it != range.second; ++it )
+      {
+        auto job = it->second.lock();
+        if ( job && job->client.get() == &client &&
+             job->solver_p != nullptr )
+        {
+          snap = job->solver_p->snapshot();
+          is_running = true;
+          break;
+        }
+      }
+    }
+
+    if ( !is_running || snap.coeff_count == 0u )
+    {
+      client.send_line( "ERROR " + id + " job is not running" );
+      return;
+    }
+    auto line = format_line( "BEST %s %lu %.9g", id.c_str(), snap.generation,
+                             snap.best_error );
+    for ( auto i = std::size_t{ 0 }; i < snap.coeff_count; i++ )
+    {
+      line += format_line( " %g", snap.coeffs[ i ] + 0.0 );
+    }
+    client.send_line( line );
+  }
+
+  void fit_daemon_t::execute( fit_job_t &job )
+  {
+    using clock_t = std::chrono::steady_clock;
+
+    // wait until submit() sends QUEUED response
+    {
+      auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+    }
+
+    if ( job.is_cancelled )
+    {
+      job.client->send_line( "RESULT " + job.id + " cancelled 0" );
+      forget( job );
+      return;
+    }
+
+    try
+    {
+      auto &ga = *m_arenas[ thread_pool_t::worker_index() ];
+      if ( job.seed != 0u )
+      {
+        prng_t::seed( job.seed );
+      }
+      ga.reset( job.settings, job.tdata );
+      {
+        auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+        job.solver_p = &ga;
+      }
+      job.client->send_line( "STARTED " + job.id );
+
+      auto status = "max_gens";
+      auto start = clock_t::now();
+      auto is_running = true;
+      while ( is_running )
+      {
+        is_running = ga.step();
+
+        if ( job.progress_interval != 0u &&
+             ga.generation() % job.progress_interval == 0u )
+        {
+          job.client->send_line( format_line(
+            "PROGRESS %s %lu %.9g %.9g %.9g", job.id.c_str(), ga.generation(),
+            ga.best_error(), ga.avg_error(), ga.mutation_rate() ) );
+        }
+
+        if ( job.is_cancelled )
+        {
+          status = "cancelled";
+          break;
+        }
+        if ( job.time_budget_ms != 0u &&
+             clock_t::now() - start >=
+               std::chrono::milliseconds( job.time_budget_ms ) )
+        {
+          status = "timeout";
+          break;
+        }
+      }
+      if ( !is_running && ga.best_error() <= job.settings.error_threshold )
+      {
+        status = "solved";
+      }
+
+      // error of result is always measured on full training data (population
+      // may be evaluated on its coreset)
+      {
+        auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+        job.solver_p = nullptr;
+      }
+      auto &&[ poly, err ] = ga.result();
+      auto line = format_line( "RESULT %s %s %lu %.9g", job.id.c_str(), status,
+                               ga.generation(), err );
+      for ( auto i = std::size_t{ 0 }; i < poly.size(); i++ )
+      {
+        line += format_line( " %g", poly[ i ] + 0.0 );  // no "-0" output
+      }
+      job.client->send_line( line );
+    }
+    catch ( ... )
+    {
+      // arena is reset by next job anyway
+      {
+        auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+        job.solver_p = nullptr;
+      }
+      job.client->send_line( "ERROR " + job.id + " job failed: " +
+                             describe( std::current_exception() ) );
+    }
+    forget( job );
+  }
+
+  void fit_daemon_t::forget( fit_job_t const &job )
+  {
+    auto lock = std::unique_lock< std::mutex >{ m_jobs_mutex };
+    // expired entries of other jobs with the same id are dropped on the way
+    auto range = m_jobs.equal_range( job.id );
+    for ( auto it = range.first; it != range.second; )
+    {
+      auto ptr = it->second.lock();
+      if ( ptr && ptr.get() != &job )
+      {
+        ++it;
+        continue;
+      }
+      it = m_jobs.erase( it );
+      if ( ptr )
+      {
+        return;
+      }
+    }
+  }
+
+}  // namespace isai
@@ -0,0 +1,128 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_DAEMON_H_INCLUDED
+#define ISAI_GENEPI_DAEMON_H_INCLUDED
+
+#include "alg.h"
+#include "net.h"
+#include "pool.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  // connection of client of fit daemon (responses of jobs running on
+  // different workers may be sent concurrently)
+  class daemon_client_t
+  {
+  public:
+    explicit daemon_client_t( socket_t sock ) : m_sock( std::move( sock ) ) {}
+
+    socket_t const &socket() const noexcept { return m_sock; }
+
+    // sends single response line (newline is appended)
+    bool send_line( std::string const &line );
+
+  private:
+    socket_t m_sock;
+    std::mutex m_send_mutex;
+  };
+
+  // single fit request received by daemon
+  struct fit_job_t
+  {
+    std::string id;
+    ga_settings_t settings;
+    training_data_t tdata;
+
+    // wall time limit of fit (0 - none)
+    std::size_t time_budget_ms = 0u;
+
+    // number of generations between progress reports (0 - none)
+    std::size_t progress_interval = 0u;
+
+    // seed of worker's random engine for this job (0 - keep current state)
+    std::uint64_t seed = 0u;
+
+    std::shared_ptr< daemon_client_t > client;
+    std::atomic< bool > is_cancelled{ false };
+
+    // arena running job (guarded by daemon's job list mutex; null unless
+    // job is running)
+    genetic_algorithm_t< 35 > *solver_p = nullptr;
+  };
+
+  // long-running fit server - accepts jobs over unix domain socket and runs
+  // them on warm thread pool, each worker reusing its own preallocated
+  // algorithm instance (population arena) between jobs
+  //
+  // protocol is line based; job is submitted as:
+  //   JOB <id>
+  //   <label>: <value>      (any config file setting, or "time budget ms",
+  //   ...                    "progress interval" and "seed")
+  //   DATA <count>
+  //   <x> <y> [<weight>]    (count lines)
+  //   END
+  // and may be cancelled with "CANCEL <id>" or queried for best solution so
+  // far with "PEEK <id>" (answered from snapshot published by running
+  // solver, without stopping it); daemon answers with lines:
+  //   QUEUED <id> <position>
+  //   STARTED <id>
+  //   PROGRESS <id> <generation> <best error> <avg error> <mutation rate>
+  //   RESULT <id> <solved|max_gens|cancelled|timeout> <generations> <error>
+  //          <coefficients (a_0 first)>
+  //   (error and coefficients are omitted if job was cancelled before start)
+  //   BEST <id> <generation> <error> <coefficients (a_0 first)>
+  //   ERROR <id> <message>
+  // jobs of client that disconnects are cancelled; daemon always runs genetic
+  // algorithm on given data, so jobs asking for other solver, order search,
+  // analytic error, certification, solution cache or input coefficients are
+  // rejected, as are jobs exceeding MAX_JOB_DATA_SIZE data points or
+  // MAX_JOB_POP_SIZE members
+  class fit_daemon_t
+  {
+  public:
+    // constructor - starts given number of workers (0 - one per hardware
+    // thread); given settings are defaults for all jobs
+    fit_daemon_t( std::string socket_path, std::size_t thread_count,
+                  ga_settings_t defaults );
+
+    // listens for clients and serves them; returns only on failure
+    int run();
+
+  private:
+    void serve_client( std::shared_ptr< daemon_client_t > client );
+
+    // reads job body (lines following JOB header); returns error message or
+    // empty string on success
+    std::string read_job( line_reader_t &reader, fit_job_t &job );
+
+    void submit( std::shared_ptr< fit_job_t > job );
+    void cancel( std::string const &id,
+                 daemon_client_t const *client_p = nullptr );
+    void peek( std::string const &id, daemon_client_t &client );
+    void execute( fit_job_t &job );
+    void forget( fit_job_t const &job );
+
+  private:
+    std::string m_socket_path;
+    ga_settings_t m_defaults;
+
+    std::vector< std::unique_ptr< genetic_algorithm_t< 35 > > > m_arenas;
+
+    std::mutex m_jobs_mutex;
+    std::multimap< std::string, std::weak_ptr< fit_job_t > > m_jobs;
+
+    // declared last, so that workers are joined before arenas are released
+    thread_pool_t m_pool;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_DAEMON_H_INCLUDED
@@ -0,0 +1 @@
+#include "de.h"
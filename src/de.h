@@ -0,0 +1,418 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_DE_H_INCLUDED
+#define ISAI_GENEPI_DE_H_INCLUDED
+
+#include "chromo.h"
+#include "eval.h"
+#include "poly.h"
+#include "prng.h"
+#include "solver.h"
+#include "warmstart.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  // differential evolution (rand/1/bin) working directly on coefficient
+  // vectors - every generation each member gets trial vector built from
+  // three other random members (a + F * ( b - c ), mixed with member by
+  // binomial crossover), snapped to grid of coefficients representable by
+  // chromosomes (multiples of 0.25 within [ -15.75, 15.75 ]); trials of
+  // whole population are encoded as chromosomes and evaluated at once by
+  // fitness evaluator, each replaces its member if not worse; differential
+  // weight is dithered per trial, so that difference vectors do not vanish
+  // on grid as population converges; stagnated population is reinitialized
+  // (except its best member)
+  template < std::size_t N >
+  class differential_evolution_t final : public solver_t< N >
+  {
+  public:
+    // number of coefficients
+    static constexpr const std::size_t K = N / 7u;
+
+    // smallest population (mutation needs three members other than target)
+    static constexpr const std::size_t MIN_POP_SIZE = 4u;
+
+    // constructor - initializes population (seeded with least-squares fit)
+    // and local evaluator for given training data; smaller population than
+    // MIN_POP_SIZE is enlarged to it
+    differential_evolution_t( ga_settings_t settings, training_data_t tdata ) :
+      m_settings( with_min_pop_size( std::move( settings ) ) ),
+      m_tdata( std::move( tdata ) ),
+      m_pop( m_settings.pop_size ),
+      m_trials( m_settings.pop_size ),
+      m_coeffs( m_settings.pop_size * K ),
+      m_trial_coeffs( m_settings.pop_size * K ),
+      m_errors( m_settings.pop_size ),
+      m_trial_errors( m_settings.pop_size ),
+      m_scratch( K )
+    {
+      assert( !m_tdata.empty() );
+      assert( m_settings.pop_size >= MIN_POP_SIZE );
+      m_settings.training_data_size = m_tdata.size();
+
+      seed_population( m_pop, m_tdata, m_settings.warm_start_fraction );
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        decode( i );
+      }
+
+      set_evaluator( make_local_evaluator< N >( m_settings.error_metric,
+                                                m_settings.huber_delta ) );
+    }
+
+    // settings of algorithm
+    ga_settings_t const &settings() const noexcept override
+    {
+      return m_settings;
+    }
+
+    // training data that population is evaluated against
+    training_data_t const &training_data() const noexcept override
+    {
+      return m_tdata;
+    }
+
+    // replaces component used for computing errors of population members
+    // (binds training data to it)
+    void set_evaluator(
+      std::shared_ptr< fitness_evaluator_t< N > > evaluator ) override
+    {
+      assert( evaluator );
+      evaluator->bind( m_tdata );
+      m_evaluator = std::move( evaluator );
+    }
+
+    // runs whole training process
+    void run() override
+    {
+      while ( step() )
+      {
+      }
+
+      print_completion_info();
+    }
+
+    // runs single generation of training process (first call evaluates
+    // initial population); returns false once stopping criteria are met
+    bool step() override
+    {
+      if ( !m_is_started )
+      {
+        evaluate_population();
+        m_is_started = true;
+        publish_state();
+      }
+      if ( check_completion_condition() )
+      {
+        return false;
+      }
+
+      create_trials();
+      m_evaluator->evaluate( m_trials, m_trial_errors );
+      m_eval_count += m_trials.size();
+      select_survivors();
+
+      if ( m_best_repeats >= m_settings.pop_reset_threshold )
+      {
+        restart_population();
+      }
+
+      print_progress();
+      m_curr_gen++;
+      publish_state();
+
+      return !check_completion_condition();
+    }
+
+    // puts given chromosomes into initial population in place of its last
+    // members
+    void seed( population_t< N > const &seeds ) override
+    {
+      assert( !m_is_started );
+      auto count = std::min( seeds.size(), m_pop.size() );
+      for ( auto i = std::size_t{ 0 }; i < count; i++ )
+      {
+        m_pop[ m_pop.size() - 1u - i ] = seeds[ i ];
+        decode( m_pop.size() - 1u - i );
+      }
+    }
+
+    // returns polynomial represented by best population member and its
+    // error
+    typename solver_t< N >::result_t result() const override
+    {
+      auto res = to_polynomial( m_pop[ m_best ] );
+      if ( m_settings.is_file_output_enabled )
+      {
+        res.to_file( std::string{ "data/" } + m_settings.batch_name +
+                     "_output_poly.tsv" );
+      }
+      return std::make_pair( res, m_errors[ m_best ] );
+    }
+
+    // progress queries
+    std::size_t generation() const noexcept override { return m_curr_gen; }
+    std::size_t evaluation_count() const noexcept override
+    {
+      return m_eval_count;
+    }
+    double best_error() const noexcept override
+    {
+      return m_is_started ? m_errors[ m_best ]
+                          : std::numeric_limits< double >::infinity();
+    }
+    double avg_error() const noexcept { return m_avg_error; }
+    bool is_done() const override
+    {
+      return m_is_started && check_completion_condition();
+    }
+
+  private:
+    /*-----------------------*/
+    /*     HELPER METHODS    */
+    /*-----------------------*/
+
+    // given settings with population enlarged to MIN_POP_SIZE if needed
+    static ga_settings_t with_min_pop_size( ga_settings_t settings )
+    {
+      settings.pop_size = std::max( settings.pop_size, MIN_POP_SIZE );
+      return settings;
+    }
+
+    // stores coefficients of chromosome at given index of population
+    void decode( std::size_t i )
+    {
+      auto poly = to_polynomial( m_pop[ i ] );
+      std::copy( &poly[ 0 ], &poly[ 0 ] + K, m_coeffs.data() + i * K );
+    }
+
+    // picks random population member other than given ones
+    std::size_t pick_other( std::size_t i, std::size_t a = SIZE_MAX,
+                            std::size_t b = SIZE_MAX ) const
+    {
+      auto res = std::size_t{ 0 };
+      do
+      {
+        res = prng_t::get_index( m_pop.size() );
+      } while ( res == i || res == a || res == b );
+      return res;
+    }
+
+    // checks if given stopping criteria are met (or solver is cancelled)
+    bool check_completion_condition() const
+    {
+      return m_curr_gen >= m_settings.max_gens ||
+             m_errors[ m_best ] <= m_settings.error_threshold ||
+             this->is_cancelled();
+    }
+
+    // publishes current state for snapshot readers
+    void publish_state() noexcept
+    {
+      auto snap = solver_snapshot_t{};
+      snap.generation = m_curr_gen;
+      snap.evaluation_count = m_eval_count;
+      snap.best_error = m_errors[ m_best ];
+      snap.avg_error = m_avg_error;
+      snap.is_done = check_completion_condition();
+      this->publish( to_polynomial( m_pop[ m_best ] ), snap );
+    }
+
+    // finds best member and average error of population
+    void update_statistics()
+    {
+      auto sum = double{ 0.0 };
+      m_best = 0u;
+      for ( auto i = std::size_t{ 0 }; i < m_errors.size(); i++ )
+      {
+        sum += m_errors[ i ];
+        if ( m_errors[ i ] < m_errors[ m_best ] )
+        {
+          m_best = i;
+        }
+      }
+      m_avg_error = sum / static_cast< double >( m_errors.size() );
+    }
+
+    /*------------------------*/
+    /*     ALGORITHM STEPS    */
+    /*------------------------*/
+
+    // computes errors of current population using evaluator
+    void evaluate_population()
+    {
+      m_evaluator->evaluate( m_pop, m_errors );
+      m_eval_count += m_pop.size();
+      update_statistics();
+    }
+
+    // builds trial vector (and its chromosome) for every population member
+    void create_trials()
+    {
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        auto r1 = pick_other( i );
+        auto r2 = pick_other( i, r1 );
+        auto r3 = pick_other( i, r1, r2 );
+        auto a_p = m_coeffs.data() + r1 * K;
+        auto b_p = m_coeffs.data() + r2 * K;
+        auto c_p = m_coeffs.data() + r3 * K;
+        auto x_p = m_coeffs.data() + i * K;
+
+        auto weight = m_settings.de_weight * ( 0.5 + prng_t::get_fraction() );
+        auto forced = prng_t::get_index( K );
+        for ( auto k = std::size_t{ 0 }; k < K; k++ )
+        {
+          m_scratch[ k ] =
+            k == forced || prng_t::get_fraction() < m_settings.de_crossover_rate
+              ? a_p[ k ] + weight * ( b_p[ k ] - c_p[ k ] )
+              : x_p[ k ];
+        }
+        normalize_coeffs( m_scratch );
+
+        std::copy( std::begin( m_scratch ), std::end( m_scratch ),
+                   m_trial_coeffs.data() + i * K );
+        m_trials[ i ] = from_coeffs< N >( m_scratch );
+      }
+    }
+
+    // replaces members by their trials unless these are worse, counts
+    // generations without improvement of best error
+    void select_survivors()
+    {
+      auto prev_best_error = m_errors[ m_best ];
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        if ( m_trial_errors[ i ] <= m_errors[ i ] )
+        {
+          m_pop[ i ] = m_trials[ i ];
+          m_errors[ i ] = m_trial_errors[ i ];
+          std::copy( m_trial_coeffs.data() + i * K,
+                     m_trial_coeffs.data() + ( i + 1u ) * K,
+                     m_coeffs.data() + i * K );
+        }
+      }
+      update_statistics();
+
+      if ( m_errors[ m_best ] < prev_best_error )
+      {
+        m_best_repeats = 0u;
+      }
+      else
+      {
+        m_best_repeats++;
+      }
+    }
+
+    // replaces all members except best one with random ones
+    void restart_population()
+    {
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
+      {
+        std::printf( "Population stagnated for %lu generations - "
+                     "restarting.\n",
+                     m_best_repeats );
+      }
+
+      auto best = m_pop[ m_best ];
+      for ( auto &&ch : m_pop )
+      {
+        ch = chromosome_t< N >{};
+      }
+      m_pop[ 0 ] = best;
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        decode( i );
+      }
+      evaluate_population();
+      m_best_repeats = 0u;
+    }
+
+    /*--------------------------*/
+    /*    INFORMATION OUTPUT    */
+    /*--------------------------*/
+
+    // writes (every print interval) progress info to stdout
+    void print_progress() const
+    {
+      if ( m_settings.is_verbose &&
+           m_curr_gen % m_settings.print_interval == 0 )
+      {
+        std::printf( "GEN# %04lu -   avg_err: %10.3f,   best_err: %10.3f,   "
+                     "reps: %7lu;\n",
+                     m_curr_gen, m_avg_error, m_errors[ m_best ],
+                     m_best_repeats );
+      }
+    }
+
+    // prints to stdout info about final state
+    void print_completion_info() const
+    {
+      if ( m_settings.is_quiet )
+      {
+        return;
+      }
+
+      if ( m_settings.is_verbose )
+      {
+        std::printf( "\n" );
+      }
+
+      if ( m_errors[ m_best ] > m_settings.error_threshold &&
+           this->is_cancelled() )
+      {
+        std::printf( "Differential evolution cancelled after %lu "
+                     "generations.\n",
+                     m_curr_gen - 1u );
+      }
+      else if ( m_errors[ m_best ] > m_settings.error_threshold )
+      {
+        std::printf(
+          "Differential evolution ended after reaching maximal number of "
+          "generations allowed without finding solution that satisfies "
+          "requested precision.\n" );
+      }
+      else
+      {
+        std::printf( "Differential evolution ended after %lu generations "
+                     "(%lu evaluations) finding solution that satisfies "
+                     "requested precision.\n",
+                     m_curr_gen - 1u, m_eval_count );
+      }
+    }
+
+  private:
+    ga_settings_t m_settings;
+    training_data_t m_tdata;
+
+    population_t< N > m_pop;
+    population_t< N > m_trials;
+    std::vector< double > m_coeffs;  // coefficients of members (row major)
+    std::vector< double > m_trial_coeffs;
+    std::vector< double > m_errors;
+    std::vector< double > m_trial_errors;
+    std::vector< double > m_scratch;
+
+    std::shared_ptr< fitness_evaluator_t< N > > m_evaluator;
+
+    std::size_t m_curr_gen = 1u;
+    std::size_t m_best = 0u;
+    std::size_t m_best_repeats = 0u;
+    std::size_t m_eval_count = 0u;
+
+    double m_avg_error = 0.0;
+
+    bool m_is_started = false;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_DE_H_INCLUDED
@@ -0,0 +1,21 @@
+#include "dist.h"
+
+namespace isai
+{
+
+  bool send_message( socket_t const &sock, msg_type_t type, std::uint64_t id,
+                     std::size_t count, void const *payload_p,
+                     std::size_t payload_size )
+  {
+    auto header = msg_header_t{ static_cast< std::uint32_t >( type ),
+                                static_cast< std::uint32_t >( count ), id };
+    return send_all( sock, &header, sizeof( header ) ) &&
+           ( payload_size == 0u || send_all( sock, payload_p, payload_size ) );
+  }
+
+  bool recv_header( socket_t const &sock, msg_header_t &header )
+  {
+    return recv_all( sock, &header, sizeof( header ) );
+  }
+
+}  // namespace isai
@@ -0,0 +1,628 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_DIST_H_INCLUDED
+#define ISAI_GENEPI_DIST_H_INCLUDED
+
+#include "eval.h"
+#include "net.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  /*----------------*/
+  /*    PROTOCOL    */
+  /*----------------*/
+
+  // kinds of messages exchanged between coordinator and workers
+  // (all values are sent in host byte order - workers are expected to run on
+  // machines of the same architecture as coordinator)
+  enum class msg_type_t : std::uint32_t
+  {
+    training_data = 1u,  // coordinator -> worker: metric_msg_t followed by
+                         // count data points
+    batch = 2u,          // coordinator -> worker: count packed chromosomes
+    errors = 3u          // worker -> coordinator: count errors of batch
+  };
+
+  // header preceding payload of every message
+  struct msg_header_t
+  {
+    std::uint32_t type;
+    std::uint32_t count;
+    std::uint64_t id;
+  };
+
+  // error metric that worker should use (sent with training data)
+  struct metric_msg_t
+  {
+    std::uint32_t kind;
+    std::uint32_t reserved;
+    double huber_delta;
+  };
+
+  // sends header followed by given payload
+  bool send_message( socket_t const &sock, msg_type_t type, std::uint64_t id,
+                     std::size_t count, void const *payload_p,
+                     std::size_t payload_size );
+
+  // receives message header
+  bool recv_header( socket_t const &sock, msg_header_t &header );
+
+
+  /*-------------------*/
+  /*    COORDINATOR    */
+  /*-------------------*/
+
+  // settings of distributed fitness evaluation
+  struct dist_settings_t
+  {
+    std::vector< std::string > endpoints;
+
+    std::size_t initial_batch_size = 64u;
+    std::size_t min_batch_size = 8u;
+    std::size_t max_batch_size = 65536u;
+    std::size_t max_in_flight = 2u;
+
+    double target_batch_ms = 20.0;
+    double slow_factor = 4.0;
+    double min_slow_timeout_ms = 250.0;
+    double lost_timeout_ms = 5000.0;
+  };
+
+  // evaluator shipping packed chromosome batches to remote workers
+  // batch sizes are adapted per worker so that every batch takes about
+  // target_batch_ms to process and max_in_flight batches are kept queued on
+  // each worker (so it never waits for network); batches of lost workers are
+  // re-dispatched and batches of slow workers are speculatively duplicated
+  // (first result wins); if no worker is alive, errors are computed locally
+  template < std::size_t N >
+  class remote_evaluator_t final : public fitness_evaluator_t< N >
+  {
+    using clock_t = std::chrono::steady_clock;
+
+    struct batch_t
+    {
+      std::size_t offset;
+      std::size_t count;
+      bool is_done;
+      bool is_duplicated;
+    };
+
+    struct in_flight_t
+    {
+      std::uint64_t id;
+      clock_t::time_point sent_at;
+    };
+
+    struct worker_link_t
+    {
+      std::string endpoint;
+      socket_t sock;
+      std::vector< in_flight_t > in_flight;
+      std::size_t batch_size;
+      double rate;  // chromosomes per millisecond (0 if not measured yet)
+    };
+
+  public:
+    // constructor - connects to all given workers (errors are computed
+    // using given metric)
+    explicit remote_evaluator_t( dist_settings_t settings,
+                                 metric_kind_t metric = metric_kind_t::l1,
+                                 double huber_delta = 1.0 ) :
+      m_settings( std::move( settings ) ),
+      m_metric{ static_cast< std::uint32_t >( metric ), 0u, huber_delta },
+      m_local( make_local_evaluator< N >( metric, huber_delta ) )
+    {
+      for ( auto &&ep : m_settings.endpoints )
+      {
+        auto host = std::string{};
+        auto port = std::uint16_t{ 0 };
+        auto sock = socket_t{};
+        if ( parse_endpoint( ep, host, port ) )
+        {
+          sock = connect_tcp( host, port );
+        }
+
+        if ( !sock.is_valid() )
+        {
+          std::printf( "Unable to connect to worker at %s.\n", ep.c_str() );
+          continue;
+        }
+
+        set_recv_timeout( sock, to_timeout( m_settings.lost_timeout_ms ) );
+        m_workers.push_back( worker_link_t{ ep, std::move( sock ), {},
+                                            m_settings.initial_batch_size,
+                                            0.0 } );
+      }
+      std::printf( "Connected to %lu of %lu workers.\n", m_workers.size(),
+                   m_settings.endpoints.size() );
+    }
+
+    // number of workers that are still alive
+    std::size_t worker_count() const noexcept { return m_workers.size(); }
+
+    void bind( training_data_t const &td ) override
+    {
+      static_assert( sizeof( data_point_t ) == 3u * sizeof( double ),
+                     "data points are sent as raw triples of doubles" );
+      m_local->bind( td );
+
+      for ( auto &&w : m_workers )
+      {
+        if ( !send_message( w.sock, msg_type_t::training_data, 0u, td.size(),
+                            &m_metric, sizeof( m_metric ) ) ||
+             !send_all( w.sock, td.data(),
+                        td.size() * sizeof( data_point_t ) ) )
+        {
+          drop_worker( w, "unable to send training data" );
+        }
+      }
+      remove_dropped_workers();
+    }
+
+    void evaluate( population_t< N > const &pop,
+                   std::vector< double > &errors ) override
+    {
+      errors.resize( pop.size() );
+      m_batches.clear();
+      m_requeued.clear();
+      m_next_offset = 0u;
+      m_done_count = 0u;
+
+      while ( m_done_count < pop.size() )
+      {
+        if ( m_workers.empty() )
+        {
+          evaluate_remaining_locally( pop, errors );
+          break;
+        }
+
+        dispatch( pop );
+        receive( errors );
+        check_timeouts();
+        remove_dropped_workers();
+      }
+
+      // ids of batches from this call must not be reused by following ones
+      m_id_base += m_batches.size();
+    }
+
+  private:
+    /*-----------------------*/
+    /*     HELPER METHODS    */
+    /*-----------------------*/
+
+    static std::size_t to_timeout( double ms )
+    {
+      return static_cast< std::size_t >( std::max( ms, 1.0 ) );
+    }
+
+    static double elapsed_ms( clock_t::time_point since )
+    {
+      return std::chrono::duration< double, std::milli >( clock_t::now() -
+                                                          since )
+        .count();
+    }
+
+    // time after which batch of given size sent to given worker is treated
+    // as delayed
+    double slow_timeout_ms( worker_link_t const &w, std::size_t count ) const
+    {
+      auto expected = w.rate > 0.0 ? static_cast< double >( count ) / w.rate
+                                   : 0.0;
+      return std::max( m_settings.min_slow_timeout_ms,
+                       expected * m_settings.slow_factor );
+    }
+
+    // marks worker as lost - its unfinished batches are queued again
+    void drop_worker( worker_link_t &w, char const *reason )
+    {
+      std::printf( "Dropping worker at %s (%s).\n", w.endpoint.c_str(),
+                   reason );
+      for ( auto &&f : w.in_flight )
+      {
+        requeue( f.id );
+      }
+      w.in_flight.clear();
+      w.sock.close();
+    }
+
+    void remove_dropped_workers()
+    {
+      m_workers.erase( std::remove_if( std::begin( m_workers ),
+                                       std::end( m_workers ),
+                                       []( worker_link_t const &w ) {
+                                         return !w.sock.is_valid();
+                                       } ),
+                       std::end( m_workers ) );
+    }
+
+    // returns batch index for given id or batch count if id is stale
+    std::size_t batch_index( std::uint64_t id ) const noexcept
+    {
+      if ( id < m_id_base || id - m_id_base >= m_batches.size() )
+      {
+        return m_batches.size();
+      }
+      return static_cast< std::size_t >( id - m_id_base );
+    }
+
+    void requeue( std::uint64_t id )
+    {
+      auto index = batch_index( id );
+      if ( index < m_batches.size() && !m_batches[ index ].is_done )
+      {
+        m_requeued.push_back( index );
+      }
+    }
+
+    // picks next batch for given worker - requeued ones first, otherwise
+    // new batch of size adapted to worker is cut from remaining population
+    bool next_batch( worker_link_t const &w, std::size_t pop_size,
+                     std::size_t &index )
+    {
+      while ( !m_requeued.empty() )
+      {
+        index = m_requeued.front();
+        m_requeued.pop_front();
+        if ( !m_batches[ index ].is_done &&
+             !is_in_flight_on( w, m_id_base + index ) )
+        {
+          return true;
+        }
+      }
+
+      if ( m_next_offset >= pop_size )
+      {
+        return false;
+      }
+
+      // do not let single worker take whole tail of population
+      auto remaining = pop_size - m_next_offset;
+      auto fair_share = ( remaining + m_workers.size() - 1u ) /
+                        m_workers.size();
+      auto count = std::min(
+        { w.batch_size, remaining,
+          std::max( fair_share, m_settings.min_batch_size ) } );
+
+      index = m_batches.size();
+      m_batches.push_back( batch_t{ m_next_offset, count, false, false } );
+      m_next_offset += count;
+      return true;
+    }
+
+    static bool is_in_flight_on( worker_link_t const &w, std::uint64_t id )
+    {
+      return std::any_of( std::begin( w.in_flight ), std::end( w.in_flight ),
+                          [id]( in_flight_t const &f ) { return f.id == id; } );
+    }
+
+    /*-----------------------*/
+    /*     PROCESSING STEPS  */
+    /*-----------------------*/
+
+    // fills free batch slots of all workers
+    void dispatch( population_t< N > const &pop )
+    {
+      for ( auto &&w : m_workers )
+      {
+        auto index = std::size_t{ 0 };
+        while ( w.sock.is_valid() &&
+                w.in_flight.size() < m_settings.max_in_flight &&
+                next_batch( w, pop.size(), index ) )
+        {
+          auto const &b = m_batches[ index ];
+          m_packed.resize( b.count * chromosome_t< N >::BYTE_COUNT );
+          auto out_p = m_packed.data();
+          for ( auto i = b.offset; i < b.offset + b.count; i++ )
+          {
+            out_p = std::copy( pop[ i ].begin(), pop[ i ].end(), out_p );
+          }
+
+          auto id = m_id_base + index;
+          if ( send_message( w.sock, msg_type_t::batch, id, b.count,
+                             m_packed.data(), m_packed.size() ) )
+          {
+            w.in_flight.push_back( in_flight_t{ id, clock_t::now() } );
+          }
+          else
+          {
+            m_requeued.push_back( index );
+            drop_worker( w, "unable to send batch" );
+          }
+        }
+      }
+    }
+
+    // waits shortly for results and stores all that arrived
+    void receive( std::vector< double > &errors )
+    {
+      m_pollfds.clear();
+      for ( auto &&w : m_workers )
+      {
+        m_pollfds.push_back( pollfd{ w.sock.fd(), POLLIN, 0 } );
+      }
+
+      if ( ::poll( m_pollfds.data(), m_pollfds.size(), 5 ) <= 0 )
+      {
+        return;
+      }
+
+      for ( auto i = std::size_t{ 0 }; i < m_workers.size(); i++ )
+      {
+        auto &w = m_workers[ i ];
+        if ( m_pollfds[ i ].revents == 0 || !w.sock.is_valid() )
+        {
+          continue;
+        }
+
+        auto header = msg_header_t{};
+        if ( !recv_header( w.sock, header ) ||
+             header.type != static_cast< std::uint32_t >( msg_type_t::errors ) )
+        {
+          drop_worker( w, "connection lost" );
+          continue;
+        }
+
+        m_received.resize( header.count );
+        if ( !recv_all( w.sock, m_received.data(),
+                        header.count * sizeof( double ) ) )
+        {
+          drop_worker( w, "connection lost" );
+          continue;
+        }
+
+        auto f_it = std::find_if( std::begin( w.in_flight ),
+                                  std::end( w.in_flight ),
+                                  [&header]( in_flight_t const &f ) {
+                                    return f.id == header.id;
+                                  } );
+        if ( f_it == std::end( w.in_flight ) )
+        {
+          continue;
+        }
+        auto took_ms = elapsed_ms( f_it->sent_at );
+        w.in_flight.erase( f_it );
+
+        auto index = batch_index( header.id );
+        if ( index == m_batches.size() )
+        {
+          continue;
+        }
+        auto &b = m_batches[ index ];
+        if ( header.count != b.count )
+        {
+          drop_worker( w, "malformed result" );
+          continue;
+        }
+
+        adapt_batch_size( w, b.count, took_ms );
+
+        if ( !b.is_done )
+        {
+          std::copy( std::begin( m_received ), std::end( m_received ),
+                     std::begin( errors ) +
+                       static_cast< std::ptrdiff_t >( b.offset ) );
+          b.is_done = true;
+          m_done_count += b.count;
+        }
+      }
+    }
+
+    // updates worker's throughput estimate and resizes its future batches
+    // (measured time includes queueing behind other in-flight batches, so it
+    // is divided among them)
+    void adapt_batch_size( worker_link_t &w, std::size_t count, double took_ms )
+    {
+      auto per_batch_ms =
+        took_ms / static_cast< double >( std::max( m_settings.max_in_flight,
+                                                   std::size_t{ 1 } ) );
+      auto rate =
+        static_cast< double >( count ) / std::max( per_batch_ms, 0.01 );
+      w.rate = w.rate > 0.0 ? 0.75 * w.rate + 0.25 * rate : rate;
+
+      auto size =
+        static_cast< std::size_t >( w.rate * m_settings.target_batch_ms );
+      w.batch_size = std::clamp( size, m_settings.min_batch_size,
+                                 m_settings.max_batch_size );
+    }
+
+    // handles delayed batches - duplicates slow ones, drops silent workers
+    void check_timeouts()
+    {
+      for ( auto &&w : m_workers )
+      {
+        for ( auto &&f : w.in_flight )
+        {
+          auto age = elapsed_ms( f.sent_at );
+          if ( age > m_settings.lost_timeout_ms )
+          {
+            drop_worker( w, "not responding" );
+            break;
+          }
+
+          auto index = batch_index( f.id );
+          if ( index == m_batches.size() || m_batches[ index ].is_done )
+          {
+            continue;
+          }
+
+          auto &b = m_batches[ index ];
+          if ( !b.is_duplicated && age > slow_timeout_ms( w, b.count ) )
+          {
+            b.is_duplicated = true;
+            m_requeued.push_back( index );
+          }
+        }
+      }
+    }
+
+    // used when all workers are lost
+    void evaluate_remaining_locally( population_t< N > const &pop,
+                                     std::vector< double > &errors )
+    {
+      auto is_done = std::vector< bool >( pop.size(), false );
+      for ( auto &&b : m_batches )
+      {
+        if ( b.is_done )
+        {
+          std::fill( std::begin( is_done ) +
+                       static_cast< std::ptrdiff_t >( b.offset ),
+                     std::begin( is_done ) +
+                       static_cast< std::ptrdiff_t >( b.offset + b.count ),
+                     true );
+        }
+      }
+
+      m_remaining.clear();
+      for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+      {
+        if ( !is_done[ i ] )
+        {
+          m_remaining.push_back( pop[ i ] );
+        }
+      }
+      m_local->evaluate( m_remaining, m_remaining_errors );
+
+      auto next = std::size_t{ 0 };
+      for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+      {
+        if ( !is_done[ i ] )
+        {
+          errors[ i ] = m_remaining_errors[ next++ ];
+        }
+      }
+      m_done_count = pop.size();
+    }
+
+  private:
+    dist_settings_t m_settings;
+    std::vector< worker_link_t > m_workers;
+    metric_msg_t m_metric;
+    std::shared_ptr< fitness_evaluator_t< N > > m_local;
+    population_t< N > m_remaining;
+    std::vector< double > m_remaining_errors;
+
+    std::vector< batch_t > m_batches;
+    std::deque< std::size_t > m_requeued;
+    std::uint64_t m_id_base = 1u;
+    std::size_t m_next_offset = 0u;
+    std::size_t m_done_count = 0u;
+
+    std::vector< byte_t > m_packed;
+    std::vector< double > m_received;
+    std::vector< pollfd > m_pollfds;
+  };
+
+
+  /*--------------*/
+  /*    WORKER    */
+  /*--------------*/
+
+  // serves fitness evaluation requests of coordinators on given port (one
+  // coordinator at a time, training data is kept per connection); messages
+  // exceeding MAX_JOB_DATA_SIZE data points or MAX_JOB_POP_SIZE chromosomes
+  // drop connection
+  template < std::size_t N >
+  int run_worker( std::uint16_t port )
+  {
+    auto listener = listen_tcp( port );
+    if ( !listener.is_valid() )
+    {
+      std::printf( "Unable to listen on port %u.\n", port );
+      return 1;
+    }
+    std::printf( "Worker listening on port %u.\n", port );
+    std::fflush( stdout );
+
+    auto tdata = training_data_t{};
+    auto metric = metric_msg_t{};
+    auto evaluator = std::shared_ptr< fitness_evaluator_t< N > >{};
+    auto packed = std::vector< byte_t >{};
+    auto pop = population_t< N >{};
+    auto errors = std::vector< double >{};
+
+    while ( true )
+    {
+      auto conn = accept_tcp( listener );
+      if ( !conn.is_valid() )
+      {
+        continue;
+      }
+      std::printf( "Coordinator connected.\n" );
+      std::fflush( stdout );
+
+      auto header = msg_header_t{};
+      while ( recv_header( conn, header ) )
+      {
+        if ( header.type ==
+             static_cast< std::uint32_t >( msg_type_t::training_data ) )
+        {
+          if ( header.count > MAX_JOB_DATA_SIZE )
+          {
+            break;
+          }
+          tdata.resize( header.count );
+          if ( !recv_all( conn, &metric, sizeof( metric ) ) ||
+               !recv_all( conn, tdata.data(),
+                          header.count * sizeof( data_point_t ) ) )
+          {
+            break;
+          }
+          evaluator = make_local_evaluator< N >(
+            static_cast< metric_kind_t >( metric.kind ), metric.huber_delta );
+          evaluator->bind( tdata );
+        }
+        else if ( header.type ==
+                  static_cast< std::uint32_t >( msg_type_t::batch ) )
+        {
+          if ( header.count > MAX_JOB_POP_SIZE )
+          {
+            break;
+          }
+          packed.resize( header.count * chromosome_t< N >::BYTE_COUNT );
+          if ( !evaluator || !recv_all( conn, packed.data(), packed.size() ) )
+          {
+            break;
+          }
+
+          pop.clear();
+          for ( auto i = std::size_t{ 0 }; i < header.count; i++ )
+          {
+            pop.emplace_back( packed.data() +
+                              i * chromosome_t< N >::BYTE_COUNT );
+          }
+          evaluator->evaluate( pop, errors );
+
+          if ( !send_message( conn, msg_type_t::errors, header.id,
+                              errors.size(), errors.data(),
+                              errors.size() * sizeof( double ) ) )
+          {
+            break;
+          }
+        }
+        else
+        {
+          break;
+        }
+      }
+
+      std::printf( "Coordinator disconnected.\n" );
+      std::fflush( stdout );
+    }
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_DIST_H_INCLUDED
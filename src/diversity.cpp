@@ -0,0 +1 @@
+#include "diversity.h"
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_DIVERSITY_H_INCLUDED
+#define ISAI_GENEPI_DIVERSITY_H_INCLUDED
+
+#include "chromo.h"
+
+namespace isai
+{
+
+  // policies of handling stagnation of population
+  enum class restart_policy_t
+  {
+    full,    // replaces whole population (including best individuals)
+    partial  // keeps elites and reseeds only part of population
+  };
+
+  // mean pairwise hamming distance of population members normalized to [0, 1]
+  // (uniformly random population scores about 0.5, fully converged one 0.0)
+  // exact for small populations, otherwise estimated from given number of
+  // randomly sampled pairs
+  template < std::size_t N >
+  double estimate_diversity( population_t< N > const &pop,
+                             std::size_t sample_count )
+  {
+    auto size = pop.size();
+    if ( size < 2u )
+    {
+      return 0.0;
+    }
+
+    auto total = std::size_t{ 0 };
+    auto pair_count = std::size_t{ 0 };
+
+    if ( size * ( size - 1u ) / 2u <= sample_count )
+    {
+      for ( auto i = std::size_t{ 0 }; i < size; i++ )
+      {
+        for ( auto j = i + 1u; j < size; j++ )
+        {
+          total += hamming_distance( pop[ i ], pop[ j ] );
+          pair_count++;
+        }
+      }
+    }
+    else
+    {
+      for ( ; pair_count < sample_count; pair_count++ )
+      {
+        auto i = prng_t::get_index( size );
+        auto j = prng_t::get_index( size - 1u );
+        j += j >= i ? 1u : 0u;
+        total += hamming_distance( pop[ i ], pop[ j ] );
+      }
+    }
+
+    return static_cast< double >( total ) /
+           static_cast< double >( pair_count * N );
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_DIVERSITY_H_INCLUDED
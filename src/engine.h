@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_ENGINE_H_INCLUDED
+#define ISAI_GENEPI_ENGINE_H_INCLUDED
+
+#include "alg.h"
+#include "de.h"
+#include "exact.h"
+#include "progressive.h"
+#include "solver.h"
+#include "stream.h"
+
+#include <memory>
+
+namespace isai
+{
+
+  // creates solver chosen by given settings for given training data;
+  // returns null if it cannot be set up (streaming one without population
+  // files)
+  template < std::size_t N >
+  std::unique_ptr< solver_t< N > > make_solver( ga_settings_t const &settings,
+                                                training_data_t tdata )
+  {
+    switch ( settings.solver )
+    {
+      case solver_kind_t::de:
+        return std::make_unique< differential_evolution_t< N > >(
+          settings, std::move( tdata ) );
+      case solver_kind_t::exact:
+        return std::make_unique< exact_solver_t< N > >( settings,
+                                                         std::move( tdata ) );
+      case solver_kind_t::progressive:
+        return std::make_unique< progressive_genetic_algorithm_t< N > >(
+          settings, std::move( tdata ) );
+      case solver_kind_t::streaming:
+      {
+        auto res = std::make_unique< streaming_genetic_algorithm_t< N > >(
+          settings, std::move( tdata ) );
+        if ( !res->is_ready() )
+        {
+          return nullptr;
+        }
+        return res;
+      }
+      case solver_kind_t::genetic:
+      default:
+        return std::make_unique< genetic_algorithm_t< N > >(
+          settings, std::move( tdata ) );
+    }
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_ENGINE_H_INCLUDED
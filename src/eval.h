@@ -0,0 +1,211 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_EVAL_H_INCLUDED
+#define ISAI_GENEPI_EVAL_H_INCLUDED
+
+#include "chromo.h"
+#include "metric.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace isai
+{
+
+  // interface of components computing approximation errors for whole
+  // population at once (locally or e.g. on remote machines)
+  template < std::size_t N >
+  class fitness_evaluator_t
+  {
+  public:
+    virtual ~fitness_evaluator_t() = default;
+
+    // sets training data that errors are computed against
+    virtual void bind( training_data_t const &td ) = 0;
+
+    // computes approximation errors for all members of given population
+    // (errors are stored at indices corresponding to population members)
+    virtual void evaluate( population_t< N > const &pop,
+                           std::vector< double > &errors ) = 0;
+  };
+
+  // evaluator computing errors sequentially in calling thread using given
+  // metric policy
+  template < std::size_t N, typename Metric = l1_metric_t >
+  class local_evaluator_t final : public fitness_evaluator_t< N >
+  {
+  public:
+    explicit local_evaluator_t( Metric metric = Metric{} ) : m_metric( metric )
+    {
+    }
+
+    void bind( training_data_t const &td ) override { m_data.assign( td ); }
+
+    void evaluate( population_t< N > const &pop,
+                   std::vector< double > &errors ) override
+    {
+      errors.resize( pop.size() );
+      for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+      {
+        errors[ i ] = eval_error( pop[ i ], m_data, m_metric );
+      }
+    }
+
+  private:
+    Metric m_metric;
+    metric_data_t m_data;
+  };
+
+  // creates local evaluator for metric chosen at runtime
+  template < std::size_t N >
+  std::shared_ptr< fitness_evaluator_t< N > >
+  make_local_evaluator( metric_kind_t kind, double huber_delta )
+  {
+    return dispatch_metric(
+      kind, huber_delta,
+      []( auto metric ) -> std::shared_ptr< fitness_evaluator_t< N > > {
+        return std::make_shared<
+          local_evaluator_t< N, decltype( metric ) > >( metric );
+      } );
+  }
+
+  // evaluator computing errors sequentially in calling thread from power
+  // table shared with evaluators of other degrees (training data given to
+  // bind is ignored - table already holds it)
+  template < std::size_t N, typename Metric = l1_metric_t >
+  class power_table_evaluator_t final : public fitness_evaluator_t< N >
+  {
+  public:
+    power_table_evaluator_t( std::shared_ptr< power_table_t const > table,
+                             Metric metric = Metric{} ) :
+      m_table( std::move( table ) ),
+      m_metric( metric )
+    {
+      assert( m_table && N / 7u <= m_table->degree() + 1u );
+    }
+
+    void bind( training_data_t const & ) override {}
+
+    void evaluate( population_t< N > const &pop,
+                   std::vector< double > &errors ) override
+    {
+      errors.resize( pop.size() );
+      for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+      {
+        errors[ i ] = eval_error( pop[ i ], *m_table, m_metric );
+      }
+    }
+
+  private:
+    std::shared_ptr< power_table_t const > m_table;
+    Metric m_metric;
+  };
+
+  // creates power table evaluator for metric chosen at runtime
+  template < std::size_t N >
+  std::shared_ptr< fitness_evaluator_t< N > >
+  make_power_table_evaluator( std::shared_ptr< power_table_t const > table,
+                              metric_kind_t kind, double huber_delta )
+  {
+    return dispatch_metric(
+      kind, huber_delta,
+      [&table]( auto metric ) -> std::shared_ptr< fitness_evaluator_t< N > > {
+        return std::make_shared<
+          power_table_evaluator_t< N, decltype( metric ) > >( table, metric );
+      } );
+  }
+
+  // evaluator for fits of known reference polynomial - computes mean
+  // squared difference of candidate and reference over whole argument
+  // interval in closed form (integral of squared difference polynomial), so
+  // that its cost does not depend on number of training data points and it
+  // is free of sampling noise; training data is ignored
+  template < std::size_t N >
+  class interval_l2_evaluator_t final : public fitness_evaluator_t< N >
+  {
+  public:
+    // constructor - takes reference coefficients (a_0 first) and interval
+    interval_l2_evaluator_t( std::vector< double > reference, double argmin,
+                             double argmax ) :
+      m_reference( std::move( reference ) ),
+      m_center( 0.5 * ( argmin + argmax ) ),
+      m_half_width( 0.5 * ( argmax - argmin ) )
+    {
+      assert( argmax > argmin );
+      m_reference.resize( std::max( m_reference.size(), N / 7u ), 0.0 );
+      m_diff.resize( m_reference.size() );
+
+      // mean of t^n over [ -1, 1 ]
+      m_moments.resize( 2u * m_reference.size() - 1u );
+      for ( auto n = std::size_t{ 0 }; n < m_moments.size(); n++ )
+      {
+        m_moments[ n ] =
+          n % 2u == 0u ? 1.0 / static_cast< double >( n + 1u ) : 0.0;
+      }
+    }
+
+    void bind( training_data_t const & ) override {}
+
+    void evaluate( population_t< N > const &pop,
+                   std::vector< double > &errors ) override
+    {
+      errors.resize( pop.size() );
+      for ( auto i = std::size_t{ 0 }; i < pop.size(); i++ )
+      {
+        errors[ i ] = interval_error( pop[ i ] );
+      }
+    }
+
+  private:
+    // difference polynomial is rewritten in argument t in [ -1, 1 ]
+    // (x = center + half_width * t, keeps quadratic form well conditioned
+    // for wide intervals) and its square is integrated term by term
+    double interval_error( chromosome_t< N > const &chromo )
+    {
+      auto poly = to_polynomial( chromo );
+      auto &d = m_diff;
+      for ( auto k = std::size_t{ 0 }; k < d.size(); k++ )
+      {
+        d[ k ] = m_reference[ k ] - ( k < poly.size() ? poly[ k ] : 0.0 );
+      }
+
+      // taylor shift to center of interval, then scaling to its half width
+      auto degree = d.size() - 1u;
+      for ( auto i = std::size_t{ 0 }; i < degree; i++ )
+      {
+        for ( auto k = degree; k-- > i; )
+        {
+          d[ k ] += m_center * d[ k + 1u ];
+        }
+      }
+      auto factor = double{ 1.0 };
+      for ( auto &&c : d )
+      {
+        c *= factor;
+        factor *= m_half_width;
+      }
+
+      auto res = double{ 0.0 };
+      for ( auto i = std::size_t{ 0 }; i < d.size(); i++ )
+      {
+        for ( auto j = std::size_t{ 0 }; j < d.size(); j++ )
+        {
+          res += d[ i ] * d[ j ] * m_moments[ i + j ];
+        }
+      }
+      return res;
+    }
+
+  private:
+    std::vector< double > m_reference;
+    std::vector< double > m_moments;
+    std::vector< double > m_diff;
+    double m_center;
+    double m_half_width;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_EVAL_H_INCLUDED
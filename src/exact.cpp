@@ -0,0 +1 @@
+#include "exact.h"
@@ -0,0 +1,429 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_EXACT_H_INCLUDED
+#define ISAI_GENEPI_EXACT_H_INCLUDED
+
+#include "alg.h"
+#include "chromo.h"
+#include "metric.h"
+#include "poly.h"
+#include "pool.h"
+#include "solver.h"
+#include "warmstart.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace isai
+{
+
+  // outcome of exact solver
+  template < std::size_t N >
+  struct exact_result_t
+  {
+    chromosome_t< N > best;
+    double error = 0.0;
+    std::size_t node_count = 0u;
+    bool is_optimal = false;  // false if node limit (or cancel) stopped it
+    bool is_cancelled = false;
+  };
+
+  // prints extent of search of exact solver and why it stopped
+  template < std::size_t N >
+  void print_exact_result( exact_result_t< N > const &res )
+  {
+    auto note = res.is_optimal
+                  ? " - solution is optimal on coefficient grid"
+                  : ( res.is_cancelled ? " (cancelled)"
+                                       : " (stopped by node limit)" );
+    std::printf( "Exact solver searched %lu boxes%s.\n", res.node_count,
+                 note );
+  }
+
+  // exact solver over grid of polynomials representable by n-gene
+  // chromosomes (127 values of every coefficient: multiples of 0.25 within
+  // [ -15.75, 15.75 ]) - branch and bound over boxes of coefficient values:
+  // error of every polynomial within box is bounded from below by applying
+  // metric to distances of residual intervals (interval arithmetic over
+  // coefficient ranges) from zero, boxes are split along coefficient that
+  // contributes widest residual interval and searched depth first; initial
+  // boxes are searched in parallel, sharing incumbent solution (least-squares
+  // fit rounded to grid or given chromosome); practical for up to four
+  // coefficients (degree 3), with exact training data also for five; as
+  // solver, whole search is its single step
+  template < std::size_t N >
+  class exact_solver_t final : public solver_t< N >
+  {
+  public:
+    // number of coefficients
+    static constexpr const std::size_t K = N / 7u;
+
+    // coefficient range in grid steps (quarters)
+    static constexpr const int MAX_QUARTERS = 63;
+
+    // constructor - uses metric, thread count and node limit of given
+    // settings
+    exact_solver_t( ga_settings_t const &settings, training_data_t tdata ) :
+      m_settings( settings ),
+      m_tdata( std::move( tdata ) ),
+      m_data( m_tdata )
+    {
+      assert( !m_tdata.empty() );
+      m_powers.resize( m_tdata.size() * K );
+      m_scales.fill( 0.0 );
+      for ( auto j = std::size_t{ 0 }; j < m_tdata.size(); j++ )
+      {
+        auto p = 0.25;
+        for ( auto k = std::size_t{ 0 }; k < K; k++ )
+        {
+          m_powers[ j * K + k ] = p;
+          m_scales[ k ] = std::max( m_scales[ k ], std::abs( p ) );
+          p *= m_tdata[ j ].x;
+        }
+      }
+
+      auto count = m_settings.thread_count != 0u
+                     ? m_settings.thread_count
+                     : std::max( 1u, std::thread::hardware_concurrency() );
+      if ( count > 1u )
+      {
+        m_pool = std::make_unique< thread_pool_t >( count - 1u );
+      }
+    }
+
+    // finds grid polynomial with least error; given chromosome (e.g. result
+    // of genetic algorithm) is used as incumbent if better than least
+    // squares one - search then certifies it (is_optimal with unchanged
+    // error) or finds better one
+    exact_result_t< N > solve( chromosome_t< N > const *incumbent_p = nullptr )
+    {
+      return dispatch_metric(
+        m_settings.error_metric, m_settings.huber_delta,
+        [this, incumbent_p]( auto metric ) {
+          return solve_with( metric, incumbent_p );
+        } );
+    }
+
+    // settings of solver
+    ga_settings_t const &settings() const noexcept override
+    {
+      return m_settings;
+    }
+
+    // training data that approximation is computed for
+    training_data_t const &training_data() const noexcept override
+    {
+      return m_tdata;
+    }
+
+    // runs search and reports its extent
+    void run() override
+    {
+      step();
+      if ( !m_settings.is_quiet )
+      {
+        print_exact_result( m_result );
+      }
+    }
+
+    // runs search (once); always returns false
+    bool step() override
+    {
+      if ( !m_is_solved )
+      {
+        m_result = solve( m_seeds.empty() ? nullptr : &m_seeds.front() );
+        m_is_solved = true;
+
+        auto snap = solver_snapshot_t{};
+        snap.generation = 1u;
+        snap.evaluation_count = m_result.node_count;
+        snap.best_error = m_result.error;
+        snap.is_done = true;
+        this->publish( to_polynomial( m_result.best ), snap );
+      }
+      return false;
+    }
+
+    // first of given chromosomes is used as incumbent
+    void seed( population_t< N > const &seeds ) override { m_seeds = seeds; }
+
+    typename solver_t< N >::result_t result() const override
+    {
+      return std::make_pair( to_polynomial( m_result.best ), m_result.error );
+    }
+
+    // bounds are computed from training data directly, so evaluator is
+    // ignored
+    void set_evaluator( std::shared_ptr< fitness_evaluator_t< N > > ) override
+    {
+    }
+
+    // progress queries (searched boxes are counted as evaluations)
+    std::size_t generation() const noexcept override
+    {
+      return m_is_solved ? 1u : 0u;
+    }
+    std::size_t evaluation_count() const noexcept override
+    {
+      return m_result.node_count;
+    }
+    double best_error() const noexcept override { return m_result.error; }
+    bool is_done() const override { return m_is_solved; }
+
+  private:
+    using quarters_t = std::array< int, K >;
+
+    // box of coefficient values (in grid steps) with lower bound of error
+    struct box_t
+    {
+      quarters_t lo;
+      quarters_t hi;
+      double bound;
+    };
+
+    // number of boxes searched by single task (once per chunk of nodes
+    // shared counter is updated and node limit checked)
+    static constexpr const std::size_t NODE_BATCH = 4096u;
+
+    template < typename Metric >
+    exact_result_t< N > solve_with( Metric const &metric,
+                                    chromosome_t< N > const *incumbent_p )
+    {
+      m_node_count = 0u;
+      m_is_aborted = false;
+      m_best_error = std::numeric_limits< double >::infinity();
+
+      auto coeffs = std::vector< double >{};
+      if ( least_squares_coeffs( m_tdata, K, coeffs ) )
+      {
+        normalize_coeffs( coeffs );
+        offer( from_coeffs< N >( coeffs ), metric );
+      }
+      if ( incumbent_p != nullptr )
+      {
+        offer( *incumbent_p, metric );
+      }
+
+      // split root box breadth first until every thread has several boxes
+      auto root = box_t{};
+      root.lo.fill( -MAX_QUARTERS );
+      root.hi.fill( MAX_QUARTERS );
+      root.bound = lower_bound( root, metric );
+
+      auto task_count = m_pool ? 16u * ( m_pool->thread_count() + 1u ) : 1u;
+      auto frontier = std::deque< box_t >{ root };
+      while ( !frontier.empty() && frontier.size() < task_count )
+      {
+        auto box = frontier.front();
+        frontier.pop_front();
+        m_node_count++;
+        if ( is_leaf( box ) )
+        {
+          offer( to_chromosome( box ), metric );
+          continue;
+        }
+        for ( auto &&child : split( box, metric ) )
+        {
+          if ( child.bound < m_best_error )
+          {
+            frontier.push_back( child );
+          }
+        }
+      }
+
+      // most promising boxes first, so that incumbent improves early
+      auto boxes = std::vector< box_t >( frontier.begin(), frontier.end() );
+      std::sort( std::begin( boxes ), std::end( boxes ),
+                 []( box_t const &lhs, box_t const &rhs ) {
+                   return lhs.bound < rhs.bound;
+                 } );
+      for_each_chunk( m_pool.get(), boxes.size(), 1u,
+                      [this, &boxes, &metric]( std::size_t b, std::size_t ) {
+                        search( boxes[ b ], metric );
+                      } );
+
+      auto res = exact_result_t< N >{};
+      res.best = m_best;
+      res.error = m_best_error;
+      res.node_count = m_node_count;
+      res.is_optimal = !m_is_aborted;
+      res.is_cancelled = m_is_aborted && this->is_cancelled();
+      return res;
+    }
+
+    // depth first search of given box
+    template < typename Metric >
+    void search( box_t const &root, Metric const &metric )
+    {
+      auto stack = std::vector< box_t >{ root };
+      auto nodes = std::size_t{ 0 };
+      while ( !stack.empty() && !m_is_aborted )
+      {
+        auto box = stack.back();
+        stack.pop_back();
+        if ( box.bound >= m_best_error )
+        {
+          continue;
+        }
+
+        if ( ++nodes == NODE_BATCH )
+        {
+          count_nodes( nodes );
+          nodes = 0u;
+        }
+
+        if ( is_leaf( box ) )
+        {
+          offer( to_chromosome( box ), metric );
+          continue;
+        }
+
+        // child with smaller bound is pushed last (searched first)
+        auto children = split( box, metric );
+        if ( children[ 0 ].bound < children[ 1 ].bound )
+        {
+          std::swap( children[ 0 ], children[ 1 ] );
+        }
+        for ( auto &&child : children )
+        {
+          if ( child.bound < m_best_error )
+          {
+            stack.push_back( child );
+          }
+        }
+      }
+      count_nodes( nodes );
+    }
+
+    // splits box in half along coefficient with widest contribution to
+    // residual intervals
+    template < typename Metric >
+    std::array< box_t, 2 > split( box_t const &box, Metric const &metric )
+    {
+      auto dim = std::size_t{ 0 };
+      auto widest = -1.0;
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        auto width =
+          static_cast< double >( box.hi[ k ] - box.lo[ k ] ) * m_scales[ k ];
+        if ( box.hi[ k ] > box.lo[ k ] && width > widest )
+        {
+          widest = width;
+          dim = k;
+        }
+      }
+
+      auto mid = box.lo[ dim ] + ( box.hi[ dim ] - box.lo[ dim ] ) / 2;
+      auto res = std::array< box_t, 2 >{ box, box };
+      res[ 0 ].hi[ dim ] = mid;
+      res[ 1 ].lo[ dim ] = mid + 1;
+      for ( auto &&child : res )
+      {
+        child.bound = lower_bound( child, metric );
+      }
+      return res;
+    }
+
+    // lower bound of error of polynomials within given box
+    template < typename Metric >
+    double lower_bound( box_t const &box, Metric const &metric ) const
+    {
+      auto acc = double{ 0.0 };
+      for ( auto j = std::size_t{ 0 }; j < m_tdata.size(); j++ )
+      {
+        auto r_lo = m_tdata[ j ].y;
+        auto r_hi = m_tdata[ j ].y;
+        auto powers_p = m_powers.data() + j * K;
+        for ( auto k = std::size_t{ 0 }; k < K; k++ )
+        {
+          auto a = static_cast< double >( box.lo[ k ] ) * powers_p[ k ];
+          auto b = static_cast< double >( box.hi[ k ] ) * powers_p[ k ];
+          r_lo -= std::max( a, b );
+          r_hi -= std::min( a, b );
+        }
+        auto dist = r_lo > 0.0 ? r_lo : ( r_hi < 0.0 ? -r_hi : 0.0 );
+        acc = metric.accumulate( acc, dist, m_tdata[ j ].w );
+      }
+      return metric.finish( acc, m_data.weight_sum() );
+    }
+
+    static bool is_leaf( box_t const &box ) noexcept
+    {
+      return box.lo == box.hi;
+    }
+
+    static chromosome_t< N > to_chromosome( box_t const &box )
+    {
+      auto coeffs = std::vector< double >( K );
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        coeffs[ k ] = 0.25 * static_cast< double >( box.lo[ k ] );
+      }
+      return from_coeffs< N >( coeffs );
+    }
+
+    // replaces incumbent with given chromosome if it is better (and
+    // publishes it - mutex keeps snapshot single writer)
+    template < typename Metric >
+    void offer( chromosome_t< N > const &chromo, Metric const &metric )
+    {
+      auto err = eval_error( chromo, m_data, metric );
+      auto lock = std::unique_lock< std::mutex >{ m_best_mutex };
+      if ( err < m_best_error )
+      {
+        m_best = chromo;
+        m_best_error = err;
+
+        auto snap = solver_snapshot_t{};
+        snap.evaluation_count = m_node_count;
+        snap.best_error = err;
+        this->publish( to_polynomial( chromo ), snap );
+      }
+    }
+
+    // counts searched boxes, aborts search at node limit or once solver is
+    // cancelled
+    void count_nodes( std::size_t nodes )
+    {
+      auto total = m_node_count += nodes;
+      if ( this->is_cancelled() ||
+           ( m_settings.exact_node_limit != 0u &&
+             total >= m_settings.exact_node_limit ) )
+      {
+        m_is_aborted = true;
+      }
+    }
+
+  private:
+    ga_settings_t m_settings;
+    training_data_t m_tdata;
+    metric_data_t m_data;
+
+    // powers of arguments scaled to grid step: 0.25 * x_j^k (point major)
+    std::vector< double > m_powers;
+    std::array< double, K > m_scales;
+
+    std::mutex m_best_mutex;
+    chromosome_t< N > m_best;
+    std::atomic< double > m_best_error{ 0.0 };
+    std::atomic< std::size_t > m_node_count{ 0u };
+    std::atomic< bool > m_is_aborted{ false };
+
+    std::unique_ptr< thread_pool_t > m_pool;
+
+    population_t< N > m_seeds;
+    exact_result_t< N > m_result;
+    bool m_is_solved = false;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_EXACT_H_INCLUDED
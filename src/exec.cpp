@@ -1,73 +1,125 @@
 #include "alg.h"
+#include "cache.h"
+#include "config.h"
+#include "daemon.h"
+#include "dist.h"
+#include "engine.h"
+#include "exact.h"
+#include "order.h"
+#include "progressive.h"
 
-void skip_to_colon( std::ifstream &fin )
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+// name of setting that analytic error (closed-form l2 error of known input
+// computed by genetic algorithm) cannot be combined with; empty if there is
+// none
+std::string analytic_error_conflict( isai::ga_settings_t const &s )
 {
-  char c = ' ';
-  while ( c != ':' )
+  if ( s.solver != isai::solver_kind_t::genetic )
+  {
+    return "solver";
+  }
+  if ( s.order_search_degree != 0u )
+  {
+    return "order search degree";
+  }
+  if ( s.error_metric != isai::metric_kind_t::l2 )
   {
-    fin.get( c );
+    return "error metric";
   }
+  // certifier measures error on training data, not over whole interval
+  if ( s.is_result_certified )
+  {
+    return "certify result";
+  }
+  return {};
 }
 
-void load_settings( isai::ga_settings_t &s )
+// prints outcomes of all degrees of order search and chosen polynomial
+void print_order_search( isai::order_search_t const &search )
 {
-  auto fin = std::ifstream{ "data/config.txt", std::ios::in };
-
-  double dbl;
-  std::string str;
-  std::size_t szt;
-
-  skip_to_colon( fin );
-  fin >> str;
-  s.is_input_random = str == "true";
-
-  skip_to_colon( fin );
-  for ( auto i = std::size_t{ 0 }; i < 5u; i++ )
+  std::printf( "Order search used %lu evaluations:\n",
+               search.evaluation_count() );
+  for ( auto &&res : search.results() )
   {
-    fin >> dbl;
-    s.input_coeffs.emplace_back( dbl );
+    if ( res.degree == 0u )
+    {
+      continue;
+    }
+    std::printf( "  degree %lu -   error: %10.4f,   bic: %10.2f,   evals: "
+                 "%9lu%s\n",
+                 res.degree, res.error, res.bic, res.evaluation_count,
+                 res.is_finished ? "" : " (cancelled)" );
   }
 
-  skip_to_colon( fin );
-  fin >> szt;
-  assert( szt > 0 );
-  s.pop_size = szt;
-
-  skip_to_colon( fin );
-  fin >> szt;
-  assert( szt > 0 );
-  s.max_gens = szt;
+  auto &&best = search.best();
+  std::printf( "Chosen degree: %lu\nResult: [", best.degree );
+  for ( auto c : best.coeffs )
+  {
+    std::printf( " %.2f", c );
+  }
+  std::printf( " ]\nError:  %.3f\n", best.error );
+}
 
-  skip_to_colon( fin );
-  fin >> szt;
-  assert( szt > 0 );
-  s.training_data_size = szt;
+// reports statistics of solution cache and seeds solver with solutions
+// cached for (exactly or nearly) the same training data
+void seed_from_cache( isai::solution_cache_t &cache,
+                      isai::data_fingerprint_t const &fp,
+                      isai::ga_settings_t const &settings,
+                      isai::solver_t< 35 > &solver )
+{
+  auto stats = cache.stats();
+  std::printf( "Solution cache: %lu entries, %lu lookups (exact hits: %lu, "
+               "near hits: %lu).\n",
+               stats.entry_count, stats.lookup_count, stats.exact_hit_count,
+               stats.near_hit_count );
 
-  skip_to_colon( fin );
-  fin >> dbl;
-  assert( dbl > 0.0 );
-  s.error_threshold = dbl;
+  auto count = std::ceil( settings.cache_seed_fraction *
+                          static_cast< double >( settings.pop_size ) );
+  auto matches = cache.lookup(
+    fp, 5u, settings.error_metric, settings.cache_match_tolerance,
+    std::max( static_cast< std::size_t >( count ), std::size_t{ 1 } ) );
+  if ( matches.empty() )
+  {
+    return;
+  }
 
-  skip_to_colon( fin );
-  fin >> dbl;
-  assert( dbl >= 0.0 && dbl <= 1.0 );
-  s.base_mutation_rate = dbl;
+  auto seeds = isai::population_t< 35 >{};
+  auto exact_count = std::size_t{ 0 };
+  for ( auto &&m : matches )
+  {
+    // solutions of progressive solver may lie off chromosome grid
+    isai::normalize_coeffs( m.coeffs );
+    seeds.push_back( isai::from_coeffs< 35 >( m.coeffs ) );
+    exact_count += m.is_exact;
+  }
+  std::printf( "Seeding %lu members from cache (exact matches: %lu, best "
+               "cached error: %.4f).\n",
+               seeds.size(), exact_count, matches.front().error );
+  solver.seed( seeds );
 }
 
-void normalize_coeffs( std::vector< double > &coeffs )
+// splits comma-separated list of worker endpoints
+std::vector< std::string > split_endpoints( std::string const &list )
 {
-  for ( auto &&c : coeffs )
+  auto res = std::vector< std::string >{};
+  auto start = std::size_t{ 0 };
+  while ( start <= list.size() )
   {
-    c = std::round( c * 4.0 ) / 4.0;
-    if ( c < -15.75 )
+    auto comma = list.find( ',', start );
+    if ( comma == std::string::npos )
     {
-      c = -15.75;
+      comma = list.size();
     }
-    else if ( c > 15.75 )
+    if ( comma > start )
     {
-      c = 15.75;
+      res.emplace_back( list.substr( start, comma - start ) );
     }
+    start = comma + 1;
   }
+  return res;
 }
 
 
@@ -76,39 +128,182 @@ int main( int argc, char *argv[] )
   isai::prng_t::initialize();
 
   auto settings = isai::ga_settings_t{};
+  auto dist_settings = isai::dist_settings_t{};
+  auto daemon_path = std::string{};
+  auto daemon_threads = std::size_t{ 0 };
 
-  if ( argc == 2 )
+  // usage: genepa [-v] [batch_name] [--workers host:port,...]
+  //        genepa --worker port
+  //        genepa --daemon socket_path [--threads n]
+  for ( auto i = 1; i < argc; i++ )
   {
-    auto param = std::string{ argv[ 1 ] };
+    auto param = std::string{ argv[ i ] };
     if ( param == "-v" )
     {
       settings.is_verbose = true;
     }
+    else if ( param == "--worker" && i + 1 < argc )
+    {
+      auto host = std::string{};
+      auto port = std::uint16_t{ 0 };
+      if ( !isai::parse_endpoint( argv[ ++i ], host, port ) ||
+           host != "127.0.0.1" )
+      {
+        std::printf( "Usage: genepa --worker port (1 - 65535)\n" );
+        return 1;
+      }
+      return isai::run_worker< 35 >( port );
+    }
+    else if ( param == "--daemon" && i + 1 < argc )
+    {
+      daemon_path = argv[ ++i ];
+    }
+    else if ( param == "--threads" && i + 1 < argc )
+    {
+      daemon_threads = std::strtoul( argv[ ++i ], nullptr, 10 );
+    }
+    else if ( param == "--workers" && i + 1 < argc )
+    {
+      dist_settings.endpoints = split_endpoints( argv[ ++i ] );
+    }
     else
     {
       settings.batch_name = param;
     }
   }
-  else if ( argc == 3 )
+
+  isai::load_settings( "data/config.txt", settings );
+
+  // config file only provides defaults for jobs received by daemon
+  if ( !daemon_path.empty() )
+  {
+    return isai::fit_daemon_t{ daemon_path, daemon_threads, settings }.run();
+  }
+
+  isai::normalize_coeffs( settings.input_coeffs );
+  if ( settings.is_error_analytic )
+  {
+    auto conflict = analytic_error_conflict( settings );
+    if ( !conflict.empty() )
+    {
+      std::printf( "Analytic error is only computed with l2 metric by "
+                   "genetic algorithm, setting \"%s\" conflicts with it.\n",
+                   conflict.c_str() );
+      return 1;
+    }
+  }
+
+  if ( settings.solver == isai::solver_kind_t::progressive )
   {
-    auto param1 = std::string{ argv[ 1 ] };
-    auto param2 = std::string{ argv[ 2 ] };
+    auto unsupported = isai::progressive_unsupported_setting( settings );
+    if ( !unsupported.empty() )
+    {
+      std::printf( "Progressive genetic algorithm does not support setting "
+                   "\"%s\".\n",
+                   unsupported.c_str() );
+      return 1;
+    }
+    if ( !dist_settings.endpoints.empty() )
+    {
+      std::printf( "Progressive genetic algorithm evaluates its population "
+                   "locally, it cannot use workers.\n" );
+      return 1;
+    }
+  }
+
+  // for other solvers (and order search) in-memory algorithm only generates
+  // training data, so its population is not allocated and data is not
+  // reduced to coreset
+  auto is_generating_only = settings.solver != isai::solver_kind_t::genetic ||
+                            settings.order_search_degree != 0u;
+  auto ga_settings = settings;
+  if ( is_generating_only )
+  {
+    ga_settings.pop_size = 1u;
+    ga_settings.coreset_size = 0u;
+    ga_settings.coreset_error_bound = 0.0;
+  }
+  auto ga = isai::genetic_algorithm_t< 35 >{ ga_settings };
 
-    settings.is_verbose = param1 == "-v";
-    settings.batch_name = param2;
+  // order search fits all degrees up to given one by chosen solver
+  if ( settings.order_search_degree != 0u )
+  {
+    auto search = isai::order_search_t{ settings, ga.training_data() };
+    std::puts( "Press any key to run..." );
+    std::getchar();
+    search.run();
+    print_order_search( search );
+    return 0;
+  }
+
+  auto other = std::unique_ptr< isai::solver_t< 35 > >{};
+  isai::solver_t< 35 > *solver_p = &ga;
+  if ( settings.solver != isai::solver_kind_t::genetic )
+  {
+    other = isai::make_solver< 35 >( settings, ga.training_data() );
+    if ( !other )
+    {
+      std::printf( "Unable to create population files in %s.\n",
+                   settings.stream_directory.c_str() );
+      return 1;
+    }
+    solver_p = other.get();
   }
 
-  load_settings( settings );
-  normalize_coeffs( settings.input_coeffs );
+  // analytic error is cheaper than sending population to workers
+  if ( !dist_settings.endpoints.empty() && !settings.is_error_analytic )
+  {
+    solver_p->set_evaluator(
+      std::make_shared< isai::remote_evaluator_t< 35 > >(
+        dist_settings, settings.error_metric, settings.huber_delta ) );
+  }
 
-  auto ga = isai::genetic_algorithm_t< 35 >{ settings };
+  auto cache = isai::solution_cache_t{};
+  // keyed by data as given (not by its randomly sampled coreset)
+  auto fp = isai::fingerprint( ga.full_training_data() );
+  if ( !settings.solution_cache_path.empty() )
+  {
+    if ( cache.open( settings.solution_cache_path ) )
+    {
+      seed_from_cache( cache, fp, settings, *solver_p );
+    }
+    else
+    {
+      std::printf( "Unable to open solution cache %s.\n",
+                   settings.solution_cache_path.c_str() );
+    }
+  }
 
   std::puts( "Press any key to run..." );
   std::getchar();
 
-  ga.run();
+  solver_p->run();
 
-  auto &&[ res, res_err ] = ga.result();
+  auto &&[ res, res_err ] = solver_p->result();
+  // analytic error is not measured on data cache entries are keyed by
+  if ( !settings.is_error_analytic )
+  {
+    cache.store( fp,
+                 std::vector< double >( &res[ 0 ], &res[ 0 ] + res.size() ),
+                 res_err, settings.error_metric );
+  }
+  if ( settings.is_result_certified &&
+       settings.solver != isai::solver_kind_t::exact )
+  {
+    // result error is measured on full data, so it is certified against it
+    auto solver =
+      isai::exact_solver_t< 35 >{ settings, ga.full_training_data() };
+    auto coeffs = std::vector< double >( &res[ 0 ], &res[ 0 ] + res.size() );
+    isai::normalize_coeffs( coeffs );
+    auto best = isai::from_coeffs< 35 >( coeffs );
+    auto exact = solver.solve( &best );
+    isai::print_exact_result( exact );
+    if ( exact.error < res_err )
+    {
+      std::printf( "Solver result is not optimal (best error: %.3f).\n",
+                   exact.error );
+    }
+  }
 
   std::printf( "Result: " );
   res.print();
@@ -0,0 +1,148 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_GENEPA_H_INCLUDED
+#define ISAI_GENEPI_GENEPA_H_INCLUDED
+
+// C interface of libgenepa - polynomial approximation engine for in-process
+// use (e.g. from python via ctypes/cffi)
+//
+// all structs passed thru this interface start with struct_size field that
+// must be set to sizeof of given struct (done by *_init functions); fields may
+// only be appended in future versions, so binaries compiled against older
+// header keep working
+//
+// solver handle is driven by one thread at a time (genepa_step / genepa_run
+// may be called from different threads, but not concurrently); each handle
+// owns its random engine, so seeded runs reproduce whichever threads step
+// them and however calls for different handles interleave, while
+// genepa_get_progress, genepa_get_best_coeffs and genepa_cancel may be
+// called from any thread at any time - they read (or flag) state published
+// lock-free by solver after every generation and never block it
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( _WIN32 )
+#define GENEPA_API __declspec( dllexport )
+#else
+#define GENEPA_API __attribute__( ( visibility( "default" ) ) )
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GENEPA_VERSION 3
+
+// status codes returned by api functions
+#define GENEPA_OK 0
+#define GENEPA_DONE 1
+#define GENEPA_ERR_INVALID_ARGUMENT -1
+#define GENEPA_ERR_OUT_OF_MEMORY -2
+#define GENEPA_ERR_INTERNAL -3
+
+// error metrics (see metric_kind_t)
+#define GENEPA_METRIC_L1 0
+#define GENEPA_METRIC_L2 1
+#define GENEPA_METRIC_LINF 2
+#define GENEPA_METRIC_HUBER 3
+
+// settings of solver (see ga_settings_t for meaning of fields)
+typedef struct genepa_settings_t
+{
+  size_t struct_size;
+
+  size_t pop_size;
+  size_t max_gens;
+  size_t mutation_rate_growth_threshold;
+  size_t pop_reset_threshold;
+
+  double error_threshold;
+  double base_mutation_rate;
+  double small_progress_rate_threshold;
+  double mutation_rate_growth_coeff;
+
+  // seed of random engine (0 - nondeterministic)
+  uint64_t seed;
+
+  // since version 2 (older structs are treated as GENEPA_METRIC_L1)
+  int error_metric;
+  double huber_delta;
+} genepa_settings_t;
+
+// snapshot of solver's progress (generation 0 and infinite errors before
+// its first step)
+typedef struct genepa_progress_t
+{
+  size_t struct_size;
+
+  size_t generation;
+  double best_error;
+  double avg_error;
+  double mutation_rate;
+  int is_done;
+} genepa_progress_t;
+
+// opaque solver handle
+typedef struct genepa_solver_t genepa_solver_t;
+
+// returns version of library (GENEPA_VERSION it was built with)
+GENEPA_API int genepa_version( void );
+
+// fills given settings with default values
+GENEPA_API int genepa_settings_init( genepa_settings_t *settings );
+
+// fills given progress struct size field
+GENEPA_API int genepa_progress_init( genepa_progress_t *progress );
+
+// creates solver approximating given training data points (count pairs of
+// xs[ i ], ys[ i ] - data is copied); returns null on failure
+GENEPA_API genepa_solver_t *genepa_create( genepa_settings_t const *settings,
+                                           double const *xs, double const *ys,
+                                           size_t count );
+
+// runs at most given number of generations; returns GENEPA_OK if solver can
+// continue or GENEPA_DONE when stopping criteria are met
+GENEPA_API int genepa_step( genepa_solver_t *solver, size_t generations );
+
+// runs solver until stopping criteria are met (returns GENEPA_DONE)
+GENEPA_API int genepa_run( genepa_solver_t *solver );
+
+// writes progress published after latest generation into caller-owned
+// struct
+GENEPA_API int genepa_get_progress( genepa_solver_t const *solver,
+                                    genepa_progress_t *progress );
+
+// writes coefficients (a_0 first) of best polynomial published after latest
+// generation (zeros before first step) into caller-owned buffer; returns
+// number of coefficients (buffer is left untouched if its capacity is too
+// small) or negative status code
+GENEPA_API int genepa_get_best_coeffs( genepa_solver_t const *solver,
+                                       double *coeffs, size_t capacity );
+
+// since version 3 - asks solver to stop; generation in progress is finished
+// and solver then reports GENEPA_DONE (result is best polynomial found so
+// far)
+GENEPA_API int genepa_cancel( genepa_solver_t *solver );
+
+// fits polynomials to many independent training data sets at once (see
+// batched_genetic_algorithm_t); points of problem p (point_counts[ p ] of
+// them) follow points of problem p - 1 in xs / ys; coefficients of p-th
+// result are written to coeffs[ p * coeff_stride ] onwards and its error to
+// errors[ p ] (may be null); returns number of coefficients per problem
+// (results are written only if it does not exceed coeff_stride) or negative
+// status code
+GENEPA_API int genepa_fit_batch( genepa_settings_t const *settings,
+                                 size_t problem_count,
+                                 size_t const *point_counts, double const *xs,
+                                 double const *ys, double *coeffs,
+                                 size_t coeff_stride, double *errors );
+
+// destroys solver (null is allowed)
+GENEPA_API void genepa_destroy( genepa_solver_t *solver );
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // !ISAI_GENEPI_GENEPA_H_INCLUDED
@@ -0,0 +1 @@
+#include "metric.h"
@@ -0,0 +1,323 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_METRIC_H_INCLUDED
+#define ISAI_GENEPI_METRIC_H_INCLUDED
+
+#include "chromo.h"
+#include "poly.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace isai
+{
+
+  // error metrics available for measuring quality of approximation (every
+  // metric honours weights of training data points)
+  enum class metric_kind_t
+  {
+    l1,    // weighted mean absolute error
+    l2,    // weighted mean squared error
+    linf,  // maximal weighted absolute error
+    huber  // weighted mean huber loss (quadratic below delta, linear above)
+  };
+
+  // number of training data points processed together by error kernels
+  // (each one has its own accumulator, so that reduction is vectorized
+  // without reassociating floating point additions)
+  constexpr const std::size_t METRIC_LANES = 4u;
+
+
+  /*-----------------------*/
+  /*    METRIC POLICIES    */
+  /*-----------------------*/
+
+  // every policy defines how weighted difference of single point is added
+  // to (lane) accumulator, how lane accumulators are combined and how final
+  // error is obtained from combined value and sum of weights
+
+  struct l1_metric_t
+  {
+    double accumulate( double acc, double diff, double w ) const noexcept
+    {
+      return acc + w * std::abs( diff );
+    }
+    static double combine( double lhs, double rhs ) noexcept
+    {
+      return lhs + rhs;
+    }
+    double finish( double acc, double weight_sum ) const noexcept
+    {
+      return acc / weight_sum;
+    }
+  };
+
+  struct l2_metric_t
+  {
+    double accumulate( double acc, double diff, double w ) const noexcept
+    {
+      return acc + w * diff * diff;
+    }
+    static double combine( double lhs, double rhs ) noexcept
+    {
+      return lhs + rhs;
+    }
+    double finish( double acc, double weight_sum ) const noexcept
+    {
+      return acc / weight_sum;
+    }
+  };
+
+  struct linf_metric_t
+  {
+    double accumulate( double acc, double diff, double w ) const noexcept
+    {
+      auto val = w * std::abs( diff );
+      return acc > val ? acc : val;
+    }
+    static double combine( double lhs, double rhs ) noexcept
+    {
+      return lhs > rhs ? lhs : rhs;
+    }
+    double finish( double acc, double ) const noexcept { return acc; }
+  };
+
+  struct huber_metric_t
+  {
+    double delta = 1.0;
+
+    // branch-free form: with m = min( |d|, delta ) loss equals
+    // m^2 / 2 + delta * ( |d| - m )
+    double accumulate( double acc, double diff, double w ) const noexcept
+    {
+      auto a = std::abs( diff );
+      auto m = a < delta ? a : delta;
+      return acc + w * ( 0.5 * m * m + delta * ( a - m ) );
+    }
+    static double combine( double lhs, double rhs ) noexcept
+    {
+      return lhs + rhs;
+    }
+    double finish( double acc, double weight_sum ) const noexcept
+    {
+      return acc / weight_sum;
+    }
+  };
+
+  // calls given function with policy object of given metric kind - the only
+  // place where metric is chosen at runtime (done once, when engine or
+  // evaluator is constructed)
+  template < typename Func >
+  decltype( auto ) dispatch_metric( metric_kind_t kind, double huber_delta,
+                                    Func &&func )
+  {
+    switch ( kind )
+    {
+    case metric_kind_t::l2:
+      return func( l2_metric_t{} );
+    case metric_kind_t::linf:
+      return func( linf_metric_t{} );
+    case metric_kind_t::huber:
+      return func( huber_metric_t{ huber_delta } );
+    case metric_kind_t::l1:
+    default:
+      return func( l1_metric_t{} );
+    }
+  }
+
+
+  /*----------------------*/
+  /*    ERROR KERNELS     */
+  /*----------------------*/
+
+  // training data in structure-of-arrays layout used by error kernels
+  // (padded with zero-weight points to multiple of METRIC_LANES)
+  class metric_data_t
+  {
+  public:
+    metric_data_t() = default;
+    explicit metric_data_t( training_data_t const &td ) { assign( td ); }
+
+    void assign( training_data_t const &td )
+    {
+      auto padded =
+        ( ( td.size() + METRIC_LANES - 1u ) / METRIC_LANES ) * METRIC_LANES;
+      m_xs.assign( padded, 0.0 );
+      m_ys.assign( padded, 0.0 );
+      m_ws.assign( padded, 0.0 );
+      m_weight_sum = 0.0;
+      for ( auto j = std::size_t{ 0 }; j < td.size(); j++ )
+      {
+        m_xs[ j ] = td[ j ].x;
+        m_ys[ j ] = td[ j ].y;
+        m_ws[ j ] = td[ j ].w;
+        m_weight_sum += td[ j ].w;
+      }
+    }
+
+    // number of points including padding
+    std::size_t padded_size() const noexcept { return m_xs.size(); }
+
+    double const *xs() const noexcept { return m_xs.data(); }
+    double const *ys() const noexcept { return m_ys.data(); }
+    double const *ws() const noexcept { return m_ws.data(); }
+    double weight_sum() const noexcept { return m_weight_sum; }
+
+  private:
+    std::vector< double > m_xs;
+    std::vector< double > m_ys;
+    std::vector< double > m_ws;
+    double m_weight_sum = 0.0;
+  };
+
+  // training data in structure-of-arrays layout together with table of
+  // powers of arguments x^0 .. x^degree (power major, padded as data) -
+  // shared by error kernels of polynomials of all degrees up to given one,
+  // so that powers are computed only once for all of them
+  class power_table_t
+  {
+  public:
+    power_table_t( training_data_t const &td, std::size_t degree ) :
+      m_data( td ),
+      m_degree( degree )
+    {
+      auto size = m_data.padded_size();
+      m_powers.assign( ( degree + 1u ) * size, 0.0 );
+      for ( auto j = std::size_t{ 0 }; j < size; j++ )
+      {
+        auto p = double{ 1.0 };
+        for ( auto k = std::size_t{ 0 }; k <= degree; k++ )
+        {
+          m_powers[ k * size + j ] = p;
+          p *= m_data.xs()[ j ];
+        }
+      }
+    }
+
+    std::size_t degree() const noexcept { return m_degree; }
+    metric_data_t const &data() const noexcept { return m_data; }
+
+    // powers x_j^k of all (padded) points
+    double const *powers( std::size_t k ) const noexcept
+    {
+      return m_powers.data() + k * m_data.padded_size();
+    }
+
+  private:
+    metric_data_t m_data;
+    std::size_t m_degree;
+    std::vector< double > m_powers;
+  };
+
+  // evaluates error of polynomial with given coefficients (a_0 first) with
+  // respect to given training data points using given metric
+  template < typename Metric, std::size_t K >
+  double eval_error( std::array< double, K > const &cs, metric_data_t const &md,
+                     Metric const &metric )
+  {
+    auto xs_p = md.xs();
+    auto ys_p = md.ys();
+    auto ws_p = md.ws();
+
+    double acc[ METRIC_LANES ] = {};
+    for ( auto j = std::size_t{ 0 }; j < md.padded_size(); j += METRIC_LANES )
+    {
+      double vals[ METRIC_LANES ];
+      for ( auto l = std::size_t{ 0 }; l < METRIC_LANES; l++ )
+      {
+        vals[ l ] = cs[ K - 1u ];
+      }
+      for ( auto k = K - 1u; k > 0; k-- )
+      {
+        for ( auto l = std::size_t{ 0 }; l < METRIC_LANES; l++ )
+        {
+          vals[ l ] = vals[ l ] * xs_p[ j + l ] + cs[ k - 1u ];
+        }
+      }
+      for ( auto l = std::size_t{ 0 }; l < METRIC_LANES; l++ )
+      {
+        acc[ l ] = metric.accumulate( acc[ l ], ys_p[ j + l ] - vals[ l ],
+                                      ws_p[ j + l ] );
+      }
+    }
+
+    auto res = acc[ 0 ];
+    for ( auto l = std::size_t{ 1 }; l < METRIC_LANES; l++ )
+    {
+      res = Metric::combine( res, acc[ l ] );
+    }
+    return metric.finish( res, md.weight_sum() );
+  }
+
+  // evaluates error of polynomial represented by given chromosome with
+  // respect to given training data points using given metric
+  template < typename Metric, std::size_t N >
+  double eval_error( chromosome_t< N > const &chromo, metric_data_t const &md,
+                     Metric const &metric )
+  {
+    constexpr const auto K = N / 7u;
+
+    auto poly = to_polynomial( chromo );
+    auto cs = std::array< double, K >{};
+    for ( auto k = std::size_t{ 0 }; k < K; k++ )
+    {
+      cs[ k ] = poly[ k ];
+    }
+    return eval_error( cs, md, metric );
+  }
+
+  // evaluates error of polynomial represented by given chromosome with
+  // respect to training data of given power table (of sufficient degree)
+  // using given metric
+  template < typename Metric, std::size_t N >
+  double eval_error( chromosome_t< N > const &chromo, power_table_t const &pt,
+                     Metric const &metric )
+  {
+    constexpr const auto K = N / 7u;
+    assert( K <= pt.degree() + 1u );
+
+    auto poly = to_polynomial( chromo );
+    double const *powers_p[ K ];
+    double cs[ K ];
+    for ( auto k = std::size_t{ 0 }; k < K; k++ )
+    {
+      cs[ k ] = poly[ k ];
+      powers_p[ k ] = pt.powers( k );
+    }
+
+    auto &&md = pt.data();
+    auto ys_p = md.ys();
+    auto ws_p = md.ws();
+
+    double acc[ METRIC_LANES ] = {};
+    for ( auto j = std::size_t{ 0 }; j < md.padded_size(); j += METRIC_LANES )
+    {
+      double vals[ METRIC_LANES ] = {};
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        for ( auto l = std::size_t{ 0 }; l < METRIC_LANES; l++ )
+        {
+          vals[ l ] += cs[ k ] * powers_p[ k ][ j + l ];
+        }
+      }
+      for ( auto l = std::size_t{ 0 }; l < METRIC_LANES; l++ )
+      {
+        acc[ l ] = metric.accumulate( acc[ l ], ys_p[ j + l ] - vals[ l ],
+                                      ws_p[ j + l ] );
+      }
+    }
+
+    auto res = acc[ 0 ];
+    for ( auto l = std::size_t{ 1 }; l < METRIC_LANES; l++ )
+    {
+      res = Metric::combine( res, acc[ l ] );
+    }
+    return metric.finish( res, md.weight_sum() );
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_METRIC_H_INCLUDED
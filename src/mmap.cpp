@@ -0,0 +1,205 @@
+#include "mmap.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+
+namespace isai
+{
+
+  namespace
+  {
+    // rounds given range outwards to page boundaries (as required by
+    // madvise) and clamps it to mapping size
+    void page_range( std::size_t size, std::size_t &offset,
+                     std::size_t &length ) noexcept
+    {
+      static auto const page = static_cast< std::size_t >( ::sysconf(
+        _SC_PAGESIZE ) );
+      auto end = std::min( size, offset + length );
+      offset = ( offset / page ) * page;
+      length = end > offset ? end - offset : 0u;
+    }
+  }  // namespace
+
+  mapped_file_t::mapped_file_t( mapped_file_t &&other ) noexcept :
+    m_data_p( other.m_data_p ),
+    m_size( other.m_size ),
+    m_fd( other.m_fd )
+  {
+    other.m_data_p = nullptr;
+    other.m_size = 0u;
+    other.m_fd = -1;
+  }
+
+  mapped_file_t &mapped_file_t::operator=( mapped_file_t &&other ) noexcept
+  {
+    if ( this != &other )
+    {
+      close();
+      std::swap( m_data_p, other.m_data_p );
+      std::swap( m_size, other.m_size );
+      std::swap( m_fd, other.m_fd );
+    }
+    return *this;
+  }
+
+  bool mapped_file_t::open( std::string const &path, std::size_t size )
+  {
+    close();
+    if ( size == 0u )
+    {
+      return false;
+    }
+
+    m_fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( m_fd < 0 )
+    {
+      return false;
+    }
+    if ( ::ftruncate( m_fd, static_cast< off_t >( size ) ) != 0 )
+    {
+      close();
+      return false;
+    }
+    if ( !map( size ) )
+    {
+      return false;
+    }
+    ::madvise( m_data_p, m_size, MADV_SEQUENTIAL );
+    return true;
+  }
+
+  bool mapped_file_t::open_existing( std::string const &path,
+                                     std::size_t initial_size )
+  {
+    close();
+    m_fd = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+    if ( m_fd < 0 )
+    {
+      return false;
+    }
+
+    struct stat st;
+    if ( ::fstat( m_fd, &st ) != 0 )
+    {
+      close();
+      return false;
+    }
+    auto size = static_cast< std::size_t >( st.st_size );
+    if ( size == 0u )
+    {
+      size = initial_size;
+      if ( size == 0u ||
+           ::ftruncate( m_fd, static_cast< off_t >( size ) ) != 0 )
+      {
+        close();
+        return false;
+      }
+    }
+    return map( size );
+  }
+
+  bool mapped_file_t::resize( std::size_t size )
+  {
+    assert( m_fd >= 0 && size != 0u );
+    ::munmap( m_data_p, m_size );
+    m_data_p = nullptr;
+    m_size = 0u;
+    if ( ::ftruncate( m_fd, static_cast< off_t >( size ) ) != 0 )
+    {
+      close();
+      return false;
+    }
+    return map( size );
+  }
+
+  bool mapped_file_t::remap_if_resized()
+  {
+    assert( m_fd >= 0 );
+    struct stat st;
+    if ( ::fstat( m_fd, &st ) != 0 )
+    {
+      close();
+      return false;
+    }
+    auto size = static_cast< std::size_t >( st.st_size );
+    if ( size == m_size )
+    {
+      return true;
+    }
+    ::munmap( m_data_p, m_size );
+    m_data_p = nullptr;
+    m_size = 0u;
+    return map( size );
+  }
+
+  bool mapped_file_t::lock() const noexcept
+  {
+    auto res = 0;
+    do
+    {
+      res = ::flock( m_fd, LOCK_EX );
+    } while ( res != 0 && errno == EINTR );
+    return res == 0;
+  }
+
+  void mapped_file_t::unlock() const noexcept { ::flock( m_fd, LOCK_UN ); }
+
+  bool mapped_file_t::map( std::size_t size )
+  {
+    auto addr_p =
+      ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+    if ( addr_p == MAP_FAILED )
+    {
+      close();
+      return false;
+    }
+    m_data_p = static_cast< unsigned char * >( addr_p );
+    m_size = size;
+    return true;
+  }
+
+  void mapped_file_t::close() noexcept
+  {
+    if ( m_data_p != nullptr )
+    {
+      ::munmap( m_data_p, m_size );
+      m_data_p = nullptr;
+      m_size = 0u;
+    }
+    if ( m_fd >= 0 )
+    {
+      ::close( m_fd );
+      m_fd = -1;
+    }
+  }
+
+  void mapped_file_t::will_need( std::size_t offset,
+                                 std::size_t length ) const noexcept
+  {
+    page_range( m_size, offset, length );
+    if ( length != 0u )
+    {
+      ::madvise( m_data_p + offset, length, MADV_WILLNEED );
+    }
+  }
+
+  void mapped_file_t::release( std::size_t offset,
+                               std::size_t length ) const noexcept
+  {
+    page_range( m_size, offset, length );
+    if ( length != 0u )
+    {
+      ::msync( m_data_p + offset, length, MS_ASYNC );
+      ::madvise( m_data_p + offset, length, MADV_DONTNEED );
+    }
+  }
+
+}  // namespace isai
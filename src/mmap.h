@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_MMAP_H_INCLUDED
+#define ISAI_GENEPI_MMAP_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+namespace isai
+{
+
+  // owning wrapper of (POSIX) shared read-write memory mapping of whole file
+  // - unmaps it and closes file on destruction
+  class mapped_file_t
+  {
+  public:
+    // default constructor - no mapping
+    mapped_file_t() noexcept = default;
+
+    // move-only
+    mapped_file_t( mapped_file_t const & ) = delete;
+    mapped_file_t &operator=( mapped_file_t const & ) = delete;
+    mapped_file_t( mapped_file_t &&other ) noexcept;
+    mapped_file_t &operator=( mapped_file_t &&other ) noexcept;
+
+    ~mapped_file_t() noexcept { close(); }
+
+    // creates (or truncates) file at given path, resizes it to given size
+    // and maps it; returns false on failure
+    bool open( std::string const &path, std::size_t size );
+
+    // opens file at given path keeping its contents and maps it whole - new
+    // (or empty) file is resized to given size first; returns false on
+    // failure
+    bool open_existing( std::string const &path, std::size_t initial_size );
+
+    // resizes mapped file (new part is zeroed) and remaps it - pointers to
+    // previous mapping are invalidated; returns false on failure (mapping
+    // is then closed)
+    bool resize( std::size_t size );
+
+    // remaps file if it was resized by other process since it was mapped;
+    // returns false on failure (mapping is then closed)
+    bool remap_if_resized();
+
+    // takes exclusive advisory lock of file (waits until other processes
+    // release it) / releases it; lock is released also by close()
+    bool lock() const noexcept;
+    void unlock() const noexcept;
+
+    // unmaps and closes file (no-op if nothing is mapped)
+    void close() noexcept;
+
+    // checks if file is mapped
+    bool is_open() const noexcept { return m_data_p != nullptr; }
+
+    unsigned char *data() const noexcept { return m_data_p; }
+    std::size_t size() const noexcept { return m_size; }
+
+    // hints kernel that given range will be accessed soon (read ahead)
+    void will_need( std::size_t offset, std::size_t length ) const noexcept;
+
+    // hints kernel that given range will not be accessed soon - starts
+    // writing it back and drops its pages from mapping (contents are kept)
+    void release( std::size_t offset, std::size_t length ) const noexcept;
+
+  private:
+    // maps given size of open file
+    bool map( std::size_t size );
+
+    unsigned char *m_data_p = nullptr;
+    std::size_t m_size = 0u;
+    int m_fd = -1;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_MMAP_H_INCLUDED
@@ -0,0 +1,280 @@
+#include "net.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+namespace isai
+{
+
+  void socket_t::close() noexcept
+  {
+    if ( m_fd >= 0 )
+    {
+      ::close( m_fd );
+      m_fd = -1;
+    }
+  }
+
+  namespace
+  {
+    // disables nagle's algorithm - messages are already batched by caller
+    void set_no_delay( int fd )
+    {
+      auto flag = int{ 1 };
+      ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof( flag ) );
+    }
+  }  // namespace
+
+  socket_t listen_tcp( std::uint16_t port )
+  {
+    auto sock = socket_t{ ::socket( AF_INET, SOCK_STREAM, 0 ) };
+    if ( !sock.is_valid() )
+    {
+      return sock;
+    }
+
+    auto flag = int{ 1 };
+    ::setsockopt( sock.fd(), SOL_SOCKET, SO_REUSEADDR, &flag, sizeof( flag ) );
+
+    auto addr = sockaddr_in{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_ANY );
+    addr.sin_port = htons( port );
+
+    if ( ::bind( sock.fd(), reinterpret_cast< sockaddr * >( &addr ),
+                 sizeof( addr ) ) != 0 ||
+         ::listen( sock.fd(), 16 ) != 0 )
+    {
+      sock.close();
+    }
+    return sock;
+  }
+
+  socket_t accept_tcp( socket_t const &listener )
+  {
+    auto fd = int{ -1 };
+    do
+    {
+      fd = ::accept( listener.fd(), nullptr, nullptr );
+    } while ( fd < 0 && errno == EINTR );
+
+    if ( fd >= 0 )
+    {
+      set_no_delay( fd );
+    }
+    return socket_t{ fd };
+  }
+
+  socket_t connect_tcp( std::string const &host, std::uint16_t port )
+  {
+    auto hints = addrinfo{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *res_p = nullptr;
+    auto service = std::to_string( port );
+    if ( ::getaddrinfo( host.c_str(), service.c_str(), &hints, &res_p ) != 0 )
+    {
+      return socket_t{};
+    }
+
+    auto sock = socket_t{};
+    for ( auto ai_p = res_p; ai_p != nullptr; ai_p = ai_p->ai_next )
+    {
+      sock = socket_t{ ::socket( ai_p->ai_family, ai_p->ai_socktype,
+                                 ai_p->ai_protocol ) };
+      if ( sock.is_valid() &&
+           ::connect( sock.fd(), ai_p->ai_addr, ai_p->ai_addrlen ) == 0 )
+      {
+        set_no_delay( sock.fd() );
+        break;
+      }
+      sock.close();
+    }
+
+    ::freeaddrinfo( res_p );
+    return sock;
+  }
+
+  namespace
+  {
+    // fills unix socket address; returns false if path is too long
+    bool to_unix_address( std::string const &path, sockaddr_un &addr )
+    {
+      addr = sockaddr_un{};
+      addr.sun_family = AF_UNIX;
+      if ( path.empty() || path.size() >= sizeof( addr.sun_path ) )
+      {
+        return false;
+      }
+      std::copy( std::begin( path ), std::end( path ), addr.sun_path );
+      return true;
+    }
+  }  // namespace
+
+  socket_t listen_unix( std::string const &path )
+  {
+    auto addr = sockaddr_un{};
+    if ( !to_unix_address( path, addr ) )
+    {
+      return socket_t{};
+    }
+
+    auto sock = socket_t{ ::socket( AF_UNIX, SOCK_STREAM, 0 ) };
+    if ( !sock.is_valid() )
+    {
+      return sock;
+    }
+
+    ::unlink( path.c_str() );
+    if ( ::bind( sock.fd(), reinterpret_cast< sockaddr * >( &addr ),
+                 sizeof( addr ) ) != 0 ||
+         ::listen( sock.fd(), 64 ) != 0 )
+    {
+      sock.close();
+    }
+    return sock;
+  }
+
+  socket_t accept_unix( socket_t const &listener )
+  {
+    auto fd = int{ -1 };
+    do
+    {
+      fd = ::accept( listener.fd(), nullptr, nullptr );
+    } while ( fd < 0 && errno == EINTR );
+    return socket_t{ fd };
+  }
+
+  socket_t connect_unix( std::string const &path )
+  {
+    auto addr = sockaddr_un{};
+    if ( !to_unix_address( path, addr ) )
+    {
+      return socket_t{};
+    }
+
+    auto sock = socket_t{ ::socket( AF_UNIX, SOCK_STREAM, 0 ) };
+    if ( sock.is_valid() &&
+         ::connect( sock.fd(), reinterpret_cast< sockaddr * >( &addr ),
+                    sizeof( addr ) ) != 0 )
+    {
+      sock.close();
+    }
+    return sock;
+  }
+
+  void set_recv_timeout( socket_t const &sock, std::size_t timeout_ms )
+  {
+    auto tv = timeval{};
+    tv.tv_sec = static_cast< time_t >( timeout_ms / 1000u );
+    tv.tv_usec = static_cast< suseconds_t >( ( timeout_ms % 1000u ) * 1000u );
+    ::setsockopt( sock.fd(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+  }
+
+  bool send_all( socket_t const &sock, void const *data_p, std::size_t size )
+  {
+    auto bytes_p = static_cast< char const * >( data_p );
+    while ( size > 0 )
+    {
+      auto sent = ::send( sock.fd(), bytes_p, size, MSG_NOSIGNAL );
+      if ( sent < 0 && errno == EINTR )
+      {
+        continue;
+      }
+      if ( sent <= 0 )
+      {
+        return false;
+      }
+      bytes_p += sent;
+      size -= static_cast< std::size_t >( sent );
+    }
+    return true;
+  }
+
+  bool recv_all( socket_t const &sock, void *data_p, std::size_t size )
+  {
+    auto bytes_p = static_cast< char * >( data_p );
+    while ( size > 0 )
+    {
+      auto got = ::recv( sock.fd(), bytes_p, size, 0 );
+      if ( got < 0 && errno == EINTR )
+      {
+        continue;
+      }
+      if ( got <= 0 )
+      {
+        return false;
+      }
+      bytes_p += got;
+      size -= static_cast< std::size_t >( got );
+    }
+    return true;
+  }
+
+  bool line_reader_t::read_line( std::string &line )
+  {
+    while ( true )
+    {
+      auto nl = m_buffer.find( '\n', m_pos );
+      if ( nl != std::string::npos )
+      {
+        line.assign( m_buffer, m_pos, nl - m_pos );
+        if ( !line.empty() && line.back() == '\r' )
+        {
+          line.pop_back();
+        }
+        m_pos = nl + 1;
+        return true;
+      }
+
+      // drop already consumed part and read more
+      m_buffer.erase( 0, m_pos );
+      m_pos = 0u;
+
+      char chunk[ 4096 ];
+      auto got = ::recv( m_sock.fd(), chunk, sizeof( chunk ), 0 );
+      if ( got < 0 && errno == EINTR )
+      {
+        continue;
+      }
+      if ( got <= 0 )
+      {
+        return false;
+      }
+      m_buffer.append( chunk, static_cast< std::size_t >( got ) );
+    }
+  }
+
+  bool parse_endpoint( std::string const &endpoint, std::string &host,
+                       std::uint16_t &port )
+  {
+    auto colon = endpoint.rfind( ':' );
+    auto port_str = endpoint;
+    host = "127.0.0.1";
+    if ( colon != std::string::npos )
+    {
+      host = endpoint.substr( 0, colon );
+      port_str = endpoint.substr( colon + 1 );
+    }
+
+    char *end_p = nullptr;
+    auto val = std::strtoul( port_str.c_str(), &end_p, 10 );
+    if ( port_str.empty() || *end_p != '\0' || val == 0 || val > 65535 )
+    {
+      return false;
+    }
+    port = static_cast< std::uint16_t >( val );
+    return !host.empty();
+  }
+
+}  // namespace isai
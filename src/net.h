@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_NET_H_INCLUDED
+#define ISAI_GENEPI_NET_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace isai
+{
+
+  // limits of single request received over network - daemon job or worker
+  // message (protect servers from oversized allocations)
+  constexpr const std::size_t MAX_JOB_DATA_SIZE = std::size_t{ 1 } << 20;
+  constexpr const std::size_t MAX_JOB_POP_SIZE = std::size_t{ 1 } << 20;
+
+  // owning wrapper of (POSIX) socket descriptor - closes it on destruction
+  class socket_t
+  {
+  public:
+    // default constructor - invalid socket
+    socket_t() noexcept = default;
+
+    // takes ownership of given descriptor
+    explicit socket_t( int fd ) noexcept : m_fd( fd ) {}
+
+    // move-only
+    socket_t( socket_t const & ) = delete;
+    socket_t &operator=( socket_t const & ) = delete;
+    socket_t( socket_t &&other ) noexcept : m_fd( other.m_fd )
+    {
+      other.m_fd = -1;
+    }
+    socket_t &operator=( socket_t &&other ) noexcept
+    {
+      if ( this != &other )
+      {
+        close();
+        m_fd = other.m_fd;
+        other.m_fd = -1;
+      }
+      return *this;
+    }
+
+    ~socket_t() noexcept { close(); }
+
+    // underlying descriptor
+    int fd() const noexcept { return m_fd; }
+
+    // checks if socket holds open descriptor
+    bool is_valid() const noexcept { return m_fd >= 0; }
+
+    // closes socket (no-op for invalid one)
+    void close() noexcept;
+
+  private:
+    int m_fd = -1;
+  };
+
+  // creates socket listening for tcp connections on given port (all
+  // interfaces); returns invalid socket on failure
+  socket_t listen_tcp( std::uint16_t port );
+
+  // waits for incoming connection on given listening socket
+  socket_t accept_tcp( socket_t const &listener );
+
+  // connects to given host on given port; returns invalid socket on failure
+  socket_t connect_tcp( std::string const &host, std::uint16_t port );
+
+  // creates unix domain stream socket listening at given path (existing file
+  // at that path is removed); returns invalid socket on failure
+  socket_t listen_unix( std::string const &path );
+
+  // waits for incoming connection on given unix domain listening socket
+  socket_t accept_unix( socket_t const &listener );
+
+  // connects to unix domain socket at given path
+  socket_t connect_unix( std::string const &path );
+
+  // sets timeout for blocking receive operations on given socket
+  void set_recv_timeout( socket_t const &sock, std::size_t timeout_ms );
+
+  // sends whole buffer; returns false on failure (e.g. peer disconnected)
+  bool send_all( socket_t const &sock, void const *data_p, std::size_t size );
+
+  // receives exactly given number of bytes; returns false on failure,
+  // timeout or orderly shutdown by peer
+  bool recv_all( socket_t const &sock, void *data_p, std::size_t size );
+
+  // buffered reader of newline-terminated text lines from socket
+  class line_reader_t
+  {
+  public:
+    explicit line_reader_t( socket_t const &sock ) noexcept : m_sock( sock ) {}
+
+    // reads next line (without terminating newline); returns false when
+    // connection is closed or broken
+    bool read_line( std::string &line );
+
+  private:
+    socket_t const &m_sock;
+    std::string m_buffer;
+    std::size_t m_pos = 0u;
+  };
+
+  // splits endpoint given as "host:port" (or just "port" for localhost)
+  bool parse_endpoint( std::string const &endpoint, std::string &host,
+                       std::uint16_t &port );
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_NET_H_INCLUDED
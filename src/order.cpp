@@ -0,0 +1 @@
+#include "order.h"
@@ -0,0 +1,320 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_ORDER_H_INCLUDED
+#define ISAI_GENEPI_ORDER_H_INCLUDED
+
+#include "engine.h"
+#include "eval.h"
+#include "metric.h"
+#include "pool.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace isai
+{
+
+  // highest degree representable by chromosomes (five coefficients)
+  constexpr const std::size_t MAX_SEARCH_DEGREE = 4u;
+
+  // outcome of fitting polynomial of single degree
+  struct degree_result_t
+  {
+    std::size_t degree = 0u;  // 0 - not fitted yet
+    std::vector< double > coeffs;  // a_0 first
+    double error = 0.0;
+    double bic = 0.0;  // bayesian information criterion of fit
+    std::size_t evaluation_count = 0u;
+    bool is_finished = false;  // false if cancelled by search
+  };
+
+  // model order search - fits polynomials of degrees 1 .. D to the same
+  // training data at once (each degree by its own solver of kind given in
+  // settings; streaming one is replaced by genetic algorithm); all of them
+  // evaluate errors from single table of argument powers built for degree
+  // D, solvers are stepped in rounds of several generations, in parallel;
+  // degree is finished when its solver stops or its best error does not
+  // improve for population reset threshold generations; after every round
+  // degrees above one that meets error threshold are cancelled, as are
+  // degrees above d + 1 once both d and d + 1 finished with information
+  // criterion of d + 1 not better than that of d (n * ln( error ) +
+  // ( d + 1 ) * ln( n )); chosen degree is the smallest one meeting error
+  // threshold, otherwise finished one with least information criterion
+  class order_search_t
+  {
+  public:
+    // generations run by every solver between checks of stopping criteria
+    static constexpr const std::size_t ROUND_GENERATIONS = 25u;
+
+    // constructor - uses order search degree, solver kind and thread count
+    // of given settings (solvers themselves run single threaded)
+    order_search_t( ga_settings_t settings, training_data_t tdata ) :
+      m_settings( std::move( settings ) ),
+      m_tdata( std::move( tdata ) )
+    {
+      assert( !m_tdata.empty() );
+      auto degree = std::min( std::max( m_settings.order_search_degree,
+                                        std::size_t{ 1 } ),
+                              MAX_SEARCH_DEGREE );
+      m_table = std::make_shared< power_table_t const >( m_tdata, degree );
+
+      auto s = m_settings;
+      s.thread_count = 1u;
+      s.is_verbose = false;
+      s.is_quiet = true;
+      s.is_file_output_enabled = false;
+      s.coreset_size = 0u;
+      s.coreset_error_bound = 0.0;
+      if ( s.solver == solver_kind_t::streaming )
+      {
+        s.solver = solver_kind_t::genetic;
+      }
+
+      m_fits.push_back( make_fit< 14 >( s ) );
+      if ( degree >= 2u )
+      {
+        m_fits.push_back( make_fit< 21 >( s ) );
+      }
+      if ( degree >= 3u )
+      {
+        m_fits.push_back( make_fit< 28 >( s ) );
+      }
+      if ( degree >= 4u )
+      {
+        m_fits.push_back( make_fit< 35 >( s ) );
+      }
+      m_results.resize( m_fits.size() );
+      m_is_active.assign( m_fits.size(), true );
+      m_least_errors.assign( m_fits.size(), 0.0 );
+      m_stalled_gens.assign( m_fits.size(), 0u );
+
+      auto count = m_settings.thread_count != 0u
+                     ? m_settings.thread_count
+                     : std::max( 1u, std::thread::hardware_concurrency() );
+      count = std::min( count, m_fits.size() );
+      if ( count > 1u )
+      {
+        m_pool = std::make_unique< thread_pool_t >( count - 1u );
+      }
+    }
+
+    // runs search until all degrees are finished or cancelled
+    void run()
+    {
+      while ( step() )
+      {
+      }
+    }
+
+    // runs single round of all active degrees; returns false once search
+    // is over
+    bool step()
+    {
+      auto active = std::vector< std::size_t >{};
+      for ( auto d = std::size_t{ 0 }; d < m_fits.size(); d++ )
+      {
+        if ( m_is_active[ d ] )
+        {
+          active.push_back( d );
+        }
+      }
+      if ( active.empty() )
+      {
+        return false;
+      }
+
+      for_each_chunk( m_pool.get(), active.size(), 1u,
+                      [this, &active]( std::size_t i, std::size_t ) {
+                        auto &&fit = *m_fits[ active[ i ] ];
+                        for ( auto g = std::size_t{ 0 };
+                              g < ROUND_GENERATIONS; g++ )
+                        {
+                          if ( !fit.step() )
+                          {
+                            break;
+                          }
+                        }
+                      } );
+
+      for ( auto d : active )
+      {
+        update_result( d );
+        m_is_active[ d ] = !m_results[ d ].is_finished;
+      }
+      apply_stopping_criteria();
+      return std::find( std::begin( m_is_active ), std::end( m_is_active ),
+                        true ) != std::end( m_is_active );
+    }
+
+    // results of all degrees (degree 1 first)
+    std::vector< degree_result_t > const &results() const noexcept
+    {
+      return m_results;
+    }
+
+    // result of chosen degree
+    degree_result_t const &best() const
+    {
+      for ( auto &&res : m_results )
+      {
+        if ( res.degree != 0u && res.error <= m_settings.error_threshold )
+        {
+          return res;
+        }
+      }
+
+      auto best = std::size_t{ 0 };
+      for ( auto d = std::size_t{ 1 }; d < m_results.size(); d++ )
+      {
+        if ( m_results[ d ].is_finished &&
+             m_results[ d ].bic < m_results[ best ].bic )
+        {
+          best = d;
+        }
+      }
+      return m_results[ best ];
+    }
+
+    // total number of error evaluations of all degrees
+    std::size_t evaluation_count() const noexcept
+    {
+      auto res = std::size_t{ 0 };
+      for ( auto &&r : m_results )
+      {
+        res += r.evaluation_count;
+      }
+      return res;
+    }
+
+  private:
+    // degree independent view of solver
+    class fit_t
+    {
+    public:
+      virtual ~fit_t() = default;
+      virtual bool step() = 0;
+      virtual bool is_done() const = 0;
+      virtual double best_error() const = 0;
+      virtual std::size_t evaluation_count() const = 0;
+      virtual std::vector< double > coeffs() const = 0;
+    };
+
+    template < std::size_t N >
+    class solver_fit_t final : public fit_t
+    {
+    public:
+      explicit solver_fit_t( std::unique_ptr< solver_t< N > > solver ) :
+        m_solver( std::move( solver ) )
+      {
+      }
+
+      bool step() override { return m_solver->step(); }
+      bool is_done() const override { return m_solver->is_done(); }
+      double best_error() const override { return m_solver->best_error(); }
+      std::size_t evaluation_count() const override
+      {
+        return m_solver->evaluation_count();
+      }
+      std::vector< double > coeffs() const override
+      {
+        auto poly = m_solver->result().first;
+        return std::vector< double >( &poly[ 0 ], &poly[ 0 ] + poly.size() );
+      }
+
+    private:
+      std::unique_ptr< solver_t< N > > m_solver;
+    };
+
+    template < std::size_t N >
+    std::unique_ptr< fit_t > make_fit( ga_settings_t const &settings ) const
+    {
+      auto solver = make_solver< N >( settings, m_tdata );
+      // progressive solver evaluates codes of its grids itself
+      if ( settings.solver != solver_kind_t::progressive )
+      {
+        solver->set_evaluator( make_power_table_evaluator< N >(
+          m_table, settings.error_metric, settings.huber_delta ) );
+      }
+      return std::make_unique< solver_fit_t< N > >( std::move( solver ) );
+    }
+
+    void update_result( std::size_t d )
+    {
+      auto &&fit = *m_fits[ d ];
+      auto &res = m_results[ d ];
+      auto n = static_cast< double >( m_tdata.size() );
+      if ( res.degree != 0u && fit.best_error() >= m_least_errors[ d ] )
+      {
+        m_stalled_gens[ d ] += ROUND_GENERATIONS;
+      }
+      else
+      {
+        m_least_errors[ d ] = fit.best_error();
+        m_stalled_gens[ d ] = 0u;
+      }
+      res.degree = d + 1u;
+      res.coeffs = fit.coeffs();
+      res.error = fit.best_error();
+      auto err = std::max( res.error, std::numeric_limits< double >::min() );
+      res.bic = n * std::log( err ) +
+                static_cast< double >( d + 2u ) * std::log( n );
+      res.evaluation_count = fit.evaluation_count();
+      res.is_finished = fit.is_done() ||
+                        m_stalled_gens[ d ] >= m_settings.pop_reset_threshold;
+    }
+
+    // cancels degrees that cannot be chosen any more
+    void apply_stopping_criteria()
+    {
+      for ( auto d = std::size_t{ 0 }; d < m_results.size(); d++ )
+      {
+        auto &&res = m_results[ d ];
+        if ( res.degree == 0u )
+        {
+          continue;
+        }
+        if ( res.error <= m_settings.error_threshold )
+        {
+          cancel_above( d );
+          return;
+        }
+        if ( d + 1u < m_results.size() && res.is_finished &&
+             m_results[ d + 1u ].is_finished &&
+             m_results[ d + 1u ].bic >= res.bic )
+        {
+          cancel_above( d + 1u );
+          return;
+        }
+      }
+    }
+
+    void cancel_above( std::size_t d )
+    {
+      for ( auto i = d + 1u; i < m_is_active.size(); i++ )
+      {
+        m_is_active[ i ] = false;
+      }
+    }
+
+  private:
+    ga_settings_t m_settings;
+    training_data_t m_tdata;
+    std::shared_ptr< power_table_t const > m_table;
+
+    std::vector< std::unique_ptr< fit_t > > m_fits;
+    std::vector< degree_result_t > m_results;
+    std::vector< bool > m_is_active;
+    std::vector< double > m_least_errors;  // best errors seen so far
+    std::vector< std::size_t > m_stalled_gens;  // since they were seen
+
+    std::unique_ptr< thread_pool_t > m_pool;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_ORDER_H_INCLUDED
@@ -19,11 +19,13 @@
 namespace isai
 {
 
-  // custom struct storing single training data point
+  // custom struct storing single training data point (with its weight in
+  // error metrics)
   struct data_point_t
   {
     double x;
     double y;
+    double w = 1.0;
   };
 
   // type alias for array of training data points
@@ -0,0 +1,77 @@
+#include "pool.h"
+
+#include "prng.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace isai
+{
+
+  thread_local std::size_t thread_pool_t::s_worker_index =  // NOLINT
+    std::numeric_limits< std::size_t >::max();
+
+  thread_pool_t::thread_pool_t( std::size_t thread_count )
+  {
+    if ( thread_count == 0u )
+    {
+      thread_count = std::max( 1u, std::thread::hardware_concurrency() );
+    }
+
+    m_threads.reserve( thread_count );
+    for ( auto i = std::size_t{ 0 }; i < thread_count; i++ )
+    {
+      m_threads.emplace_back( [this, i]() { worker_loop( i ); } );
+    }
+  }
+
+  thread_pool_t::~thread_pool_t()
+  {
+    {
+      auto lock = std::unique_lock< std::mutex >{ m_mutex };
+      m_is_stopping = true;
+    }
+    m_cv.notify_all();
+
+    for ( auto &&t : m_threads )
+    {
+      t.join();
+    }
+  }
+
+  std::size_t thread_pool_t::submit( std::function< void() > task )
+  {
+    auto waiting = std::size_t{ 0 };
+    {
+      auto lock = std::unique_lock< std::mutex >{ m_mutex };
+      waiting = m_tasks.size();
+      m_tasks.push_back( std::move( task ) );
+    }
+    m_cv.notify_one();
+    return waiting;
+  }
+
+  void thread_pool_t::worker_loop( std::size_t index )
+  {
+    s_worker_index = index;
+    prng_t::initialize();
+
+    while ( true )
+    {
+      auto task = std::function< void() >{};
+      {
+        auto lock = std::unique_lock< std::mutex >{ m_mutex };
+        m_cv.wait( lock,
+                   [this]() { return m_is_stopping || !m_tasks.empty(); } );
+        if ( m_tasks.empty() )
+        {
+          return;
+        }
+        task = std::move( m_tasks.front() );
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+}  // namespace isai
@@ -0,0 +1,161 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_POOL_H_INCLUDED
+#define ISAI_GENEPI_POOL_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace isai
+{
+
+  // fixed set of warm worker threads executing queued tasks
+  // (each worker initializes its own random engine on start)
+  class thread_pool_t
+  {
+  public:
+    // constructor - starts given number of workers (0 - one per hardware
+    // thread)
+    explicit thread_pool_t( std::size_t thread_count = 0u );
+
+    // not copyable nor movable - workers refer to pool
+    thread_pool_t( thread_pool_t const & ) = delete;
+    thread_pool_t &operator=( thread_pool_t const & ) = delete;
+
+    // finishes all queued tasks and joins workers
+    ~thread_pool_t();
+
+    // queues task for execution; returns number of tasks that were waiting
+    // in queue before it (task must not throw - exception escaping it
+    // terminates process, as for std::thread)
+    std::size_t submit( std::function< void() > task );
+
+    // calls given function for every index in [ 0, count ) using calling
+    // thread and pool workers, returns once all calls are finished; calling
+    // thread claims indices too, so it is safe to call from within pool task
+    // (even if all other workers are busy); if any call throws, indices not
+    // started yet are skipped and first exception is rethrown in calling
+    // thread once all started calls are finished
+    template < typename Func >
+    void parallel_for( std::size_t count, Func &&func )
+    {
+      if ( count == 0u )
+      {
+        return;
+      }
+
+      struct state_t
+      {
+        std::atomic< std::size_t > next{ 0u };
+        std::atomic< std::size_t > done{ 0u };
+        std::atomic< bool > is_failed{ false };
+        std::exception_ptr error;  // first one thrown (guarded by mutex)
+        std::mutex mutex;
+        std::condition_variable cv;
+      };
+      auto state = std::make_shared< state_t >();
+
+      // helpers that start after all indices are claimed return without
+      // touching func (which may be gone by then)
+      auto work = [state, count, &func]() {
+        for ( auto i = state->next++; i < count; i = state->next++ )
+        {
+          try
+          {
+            if ( !state->is_failed )
+            {
+              func( i );
+            }
+          }
+          catch ( ... )
+          {
+            auto lock = std::unique_lock< std::mutex >{ state->mutex };
+            if ( !state->error )
+            {
+              state->error = std::current_exception();
+            }
+            state->is_failed = true;
+          }
+
+          // counted even if call failed, so that caller is not left waiting
+          if ( ++state->done == count )
+          {
+            auto lock = std::unique_lock< std::mutex >{ state->mutex };
+            state->cv.notify_all();
+          }
+        }
+      };
+
+      auto helper_count = std::min( thread_count(), count - 1u );
+      for ( auto h = std::size_t{ 0 }; h < helper_count; h++ )
+      {
+        submit( work );
+      }
+      work();
+
+      auto lock = std::unique_lock< std::mutex >{ state->mutex };
+      state->cv.wait( lock,
+                      [&state, count]() { return state->done == count; } );
+      if ( state->error )
+      {
+        std::rethrow_exception( state->error );
+      }
+    }
+
+    // number of worker threads
+    std::size_t thread_count() const noexcept { return m_threads.size(); }
+
+    // index of pool worker executing calling thread (maximal value of size_t
+    // if called from outside of pool)
+    static std::size_t worker_index() noexcept { return s_worker_index; }
+
+  private:
+    void worker_loop( std::size_t index );
+
+  private:
+    std::vector< std::thread > m_threads;
+    std::deque< std::function< void() > > m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_stopping = false;
+
+    static thread_local std::size_t s_worker_index;
+  };
+
+  // splits range [ 0, count ) into chunks of given size and calls given
+  // function with bounds of every chunk - in parallel if pool is given,
+  // otherwise sequentially in calling thread
+  template < typename Func >
+  void for_each_chunk( thread_pool_t *pool_p, std::size_t count,
+                       std::size_t chunk_size, Func &&func )
+  {
+    auto chunk_count = ( count + chunk_size - 1u ) / chunk_size;
+    auto run_chunk = [&]( std::size_t c ) {
+      func( c * chunk_size, std::min( count, ( c + 1u ) * chunk_size ) );
+    };
+
+    if ( pool_p == nullptr || chunk_count < 2u )
+    {
+      for ( auto c = std::size_t{ 0 }; c < chunk_count; c++ )
+      {
+        run_chunk( c );
+      }
+    }
+    else
+    {
+      pool_p->parallel_for( chunk_count, run_chunk );
+    }
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_POOL_H_INCLUDED
@@ -3,6 +3,7 @@
 namespace isai
 {
   std::random_device prng_t::s_dev = std::random_device{};  // NOLINT
-  std::default_random_engine prng_t::s_eng =                // NOLINT
+  thread_local std::default_random_engine prng_t::s_eng =   // NOLINT
     std::default_random_engine{};                           // NOLINT
+  thread_local std::uint64_t prng_t::s_word_state = 0u;     // NOLINT
 }  // namespace isai
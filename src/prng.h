@@ -6,7 +6,9 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <random>
+#include <utility>
 #include <vector>
 
 namespace isai
@@ -16,16 +18,45 @@ namespace isai
   using byte_t = unsigned char;
 
   // random number generation utils
+  // (every thread uses its own engine - threads other than main one should
+  // call initialize() or seed() before using it)
   class prng_t
   {
   private:
     prng_t() noexcept = default;
 
   public:
+    // state of random engines of single thread
+    struct state_t
+    {
+      std::default_random_engine eng;
+      std::uint64_t word_state = 0u;
+    };
+
     // initializes prng device
     static void initialize() noexcept
     {
       s_eng = std::default_random_engine{ s_dev() };
+      s_word_state = ( std::uint64_t{ s_dev() } << 32u ) | s_dev();
+    }
+
+    // reseeds prng device of calling thread with given value (reproducible
+    // runs)
+    static void seed( std::uint64_t value ) noexcept
+    {
+      s_eng.seed(
+        static_cast< std::default_random_engine::result_type >( value ) );
+      s_word_state = value;
+    }
+
+    // replaces state of random engines of calling thread with given one and
+    // returns previous one (lets computation own its random state, so that it
+    // is reproducible whichever thread carries it on)
+    static state_t exchange_state( state_t state ) noexcept
+    {
+      std::swap( state.eng, s_eng );
+      std::swap( state.word_state, s_word_state );
+      return state;
     }
 
     // gets array of random doubles from given range
@@ -55,6 +86,23 @@ namespace isai
       }
     }
 
+    // random 64-bit word (splitmix64 - cheap source of whole words of
+    // random bits, e.g. for masks of bit-sliced population)
+    static std::uint64_t get_word() noexcept
+    {
+      auto z = s_word_state += 0x9e3779b97f4a7c15u;
+      z = ( z ^ ( z >> 30u ) ) * 0xbf58476d1ce4e5b9u;
+      z = ( z ^ ( z >> 27u ) ) * 0x94d049bb133111ebu;
+      return z ^ ( z >> 31u );
+    }
+
+    // random value from range [0, 1) made of random word (cheaper than
+    // get_fraction)
+    static double get_word_fraction() noexcept
+    {
+      return static_cast< double >( get_word() >> 11u ) * 0x1.0p-53;
+    }
+
     // probability [0,1] to binary success/failure
     static bool perc_check( double perc ) noexcept
     {
@@ -63,6 +111,12 @@ namespace isai
       return perc >= std::generate_canonical< double, 64 >( s_eng );
     }
 
+    // random value from range [0, 1)
+    static double get_fraction()
+    {
+      return std::generate_canonical< double, 64 >( s_eng );
+    }
+
     // random index for chromosome crossover point
     template < std::size_t N >
     static std::size_t get_crossover_point()
@@ -71,6 +125,14 @@ namespace isai
       return dist( s_eng );
     }
 
+    // random index from range [0, size)
+    static std::size_t get_index( std::size_t size )
+    {
+      assert( size > 0 );
+      auto dist = std::uniform_int_distribution< std::size_t >{ 0, size - 1 };
+      return dist( s_eng );
+    }
+
     // picks random index from array of increasing probabilities (cdf)
     static std::size_t pick_by_prob( std::vector< double > const &table )
     {
@@ -89,12 +151,13 @@ namespace isai
     template < typename T >
     static void shuffle( std::vector< T > &v )
     {
-      std::random_shuffle( std::begin( v ), std::end( v ) );
+      std::shuffle( std::begin( v ), std::end( v ), s_eng );
     }
 
   private:
     static std::random_device s_dev;
-    static std::default_random_engine s_eng;
+    static thread_local std::default_random_engine s_eng;
+    static thread_local std::uint64_t s_word_state;
   };
 
 }  // namespace isai
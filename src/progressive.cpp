@@ -0,0 +1,86 @@
+#include "progressive.h"
+
+namespace isai
+{
+
+  coeff_grid_t::coeff_grid_t( std::size_t bits ) :
+    m_bits( bits ),
+    m_step( std::ldexp( 1.0, 5 - static_cast< int >( bits ) ) ),
+    m_values( std::size_t{ 1 } << bits )
+  {
+    assert( bits >= MIN_CODE_BITS && bits <= MAX_CODE_BITS );
+    for ( auto code = std::uint64_t{ 0 }; code < m_values.size(); code++ )
+    {
+      auto steps = std::uint64_t{ 0 };
+      for ( auto b = std::size_t{ 1 }; b < m_bits; b++ )
+      {
+        steps = 2u * steps + ( ( code >> b ) & 1u );
+      }
+      auto magnitude = m_step * static_cast< double >( steps );
+      m_values[ code ] = ( code & 1u ) != 0u ? -magnitude : magnitude;
+    }
+  }
+
+  std::uint64_t coeff_grid_t::encode( double value ) const noexcept
+  {
+    auto max_steps = ( std::uint64_t{ 1 } << ( m_bits - 1u ) ) - 1u;
+    auto steps = static_cast< std::uint64_t >( std::llround( std::min(
+      std::abs( value ) / m_step, static_cast< double >( max_steps ) ) ) );
+
+    auto res = std::uint64_t{ value < 0.0 ? 1u : 0u };
+    for ( auto b = std::size_t{ 1 }; b < m_bits; b++ )
+    {
+      res |= ( ( steps >> ( m_bits - 1u - b ) ) & 1u ) << b;
+    }
+    return res;
+  }
+
+  std::uint64_t expand_codes( std::uint64_t word, std::size_t count,
+                              std::size_t bits,
+                              std::size_t expanded_bits ) noexcept
+  {
+    assert( bits <= expanded_bits && count * expanded_bits <= 64u );
+    auto mask = ( std::uint64_t{ 1 } << bits ) - 1u;
+    auto res = std::uint64_t{ 0 };
+    for ( auto k = std::size_t{ 0 }; k < count; k++ )
+    {
+      res |= ( ( word >> ( k * bits ) ) & mask ) << ( k * expanded_bits );
+    }
+    return res;
+  }
+
+  std::string progressive_unsupported_setting( ga_settings_t const &s )
+  {
+    if ( s.is_gene_rate_adaptive )
+    {
+      return "adaptive gene rates";
+    }
+    if ( s.is_population_bit_sliced )
+    {
+      return "bit sliced population";
+    }
+    if ( s.restart_policy != restart_policy_t::full )
+    {
+      return "restart policy";
+    }
+    // order search runs its solvers on single thread and on full data
+    if ( s.order_search_degree != 0u )
+    {
+      return {};
+    }
+    if ( s.thread_count != 1u )
+    {
+      return "thread count";
+    }
+    if ( s.coreset_size != 0u )
+    {
+      return "coreset size";
+    }
+    if ( s.coreset_error_bound != 0.0 )
+    {
+      return "coreset error bound";
+    }
+    return {};
+  }
+
+}  // namespace isai
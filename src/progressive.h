@@ -0,0 +1,705 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_PROGRESSIVE_H_INCLUDED
+#define ISAI_GENEPI_PROGRESSIVE_H_INCLUDED
+
+#include "chromo.h"
+#include "eval.h"
+#include "metric.h"
+#include "poly.h"
+#include "prng.h"
+#include "solver.h"
+#include "warmstart.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  // bounds of number of bits of coefficient codes
+  constexpr const std::size_t MIN_CODE_BITS = 2u;
+  constexpr const std::size_t MAX_CODE_BITS = 12u;
+
+  // grid of coefficients encoded by codes of given number of bits - bit 0
+  // is sign, remaining ones are magnitude in steps (most significant first,
+  // as in chromosomes); most significant magnitude bit is worth 8 whatever
+  // the width, so that all grids span (almost) [ -16, 16 ] and every
+  // additional bit halves step - 7-bit grid is that of chromosomes (step
+  // 0.25); code of value of coarser grid is also its code in finer one
+  // (missing low order magnitude bits are zero)
+  class coeff_grid_t
+  {
+  public:
+    explicit coeff_grid_t( std::size_t bits = 7u );
+
+    std::size_t bits() const noexcept { return m_bits; }
+    double step() const noexcept { return m_step; }
+
+    // value of given code (looked up in table)
+    double decode( std::uint64_t code ) const noexcept
+    {
+      assert( code < m_values.size() );
+      return m_values[ code ];
+    }
+
+    // code of grid value nearest to given one (clamped to range of grid)
+    std::uint64_t encode( double value ) const noexcept;
+
+  private:
+    std::size_t m_bits;
+    double m_step;
+    std::vector< double > m_values;  // of all codes
+  };
+
+  // promotes given number of codes packed in given word (code k at bits
+  // k * bits ..) to codes of given larger width representing the same
+  // values - deterministic bit expansion: every code keeps its bits and
+  // gets zero low order magnitude bits appended
+  std::uint64_t expand_codes( std::uint64_t word, std::size_t count,
+                              std::size_t bits,
+                              std::size_t expanded_bits ) noexcept;
+
+  // name of setting that progressive genetic algorithm does not honour -
+  // it breeds packed codes on single thread, with uniform mutation rate,
+  // evaluates them on all training data (unless order search runs it) and
+  // restarts whole schedule when it stalls; empty if there is none
+  std::string progressive_unsupported_setting( ga_settings_t const &s );
+
+  // genetic algorithm searching coarse-to-fine - members are words of
+  // packed coefficient codes and search runs in stages of growing code
+  // width (precision stages of settings, e.g. 3, 5, 7 and 9 bits, i.e.
+  // steps of 4, 1, 0.25 and 0.0625), all of them within single run:
+  //   - early stages evolve quickly on small search spaces of high order
+  //     bits; once best error of stage stalled for given number of
+  //     generations (stage stall threshold), population is promoted to
+  //     next grid by bit expansion (every member keeps its value) and
+  //     members other than best one are spread over neighbouring cells of
+  //     coarse grid, so that new low order bits are not all equal
+  //   - last stage (that may be finer than chromosome grid) runs until
+  //     stopping criteria of settings are met - whenever it stalls, members
+  //     are spread around best one again (off by few steps in every
+  //     coefficient); if best error found so far did not improve for
+  //     population reset threshold generations, whole schedule starts over
+  //     from first stage with new population
+  // selection is proportional to inverse error, crossover is single point,
+  // mutation is skip sampled and best member is always kept; best solution
+  // found in any stage is the result (settings it does not honour are
+  // named by progressive_unsupported_setting)
+  template < std::size_t N >
+  class progressive_genetic_algorithm_t final : public solver_t< N >
+  {
+  public:
+    // number of coefficients
+    static constexpr const std::size_t K = N / 7u;
+
+    static_assert( K * MAX_CODE_BITS <= 64u,
+                   "coefficient codes do not fit in single word" );
+
+    // largest offset (in steps of grid) of members spread around best one
+    static constexpr const std::size_t SPREAD_STEPS = 2u;
+
+    // constructor - initializes population of first stage (seeded with
+    // least-squares fit) for given training data
+    progressive_genetic_algorithm_t( ga_settings_t settings,
+                                     training_data_t tdata ) :
+      m_settings( std::move( settings ) ),
+      m_tdata( std::move( tdata ) ),
+      m_data( m_tdata ),
+      m_pop( m_settings.pop_size ),
+      m_next( m_settings.pop_size ),
+      m_errors( m_settings.pop_size ),
+      m_fits( m_settings.pop_size ),
+      m_mutation_rate( m_settings.base_mutation_rate )
+    {
+      assert( !m_tdata.empty() );
+      assert( m_settings.pop_size >= 2u );
+      m_settings.training_data_size = m_tdata.size();
+
+      // stages are of increasing widths within bounds
+      for ( auto bits : m_settings.precision_stages )
+      {
+        if ( bits >= MIN_CODE_BITS && bits <= MAX_CODE_BITS &&
+             ( m_stages.empty() || bits > m_stages.back() ) )
+        {
+          m_stages.push_back( bits );
+        }
+      }
+      if ( m_stages.empty() )
+      {
+        m_stages.push_back( 7u );
+      }
+
+      initialize_population();
+    }
+
+    // settings of algorithm
+    ga_settings_t const &settings() const noexcept override
+    {
+      return m_settings;
+    }
+
+    // training data that population is evaluated against
+    training_data_t const &training_data() const noexcept override
+    {
+      return m_tdata;
+    }
+
+    // not supported - chromosome evaluators cannot compute errors of codes
+    // of other grids, so population is always evaluated locally; throws
+    // std::logic_error
+    void set_evaluator( std::shared_ptr< fitness_evaluator_t< N > > ) override
+    {
+      throw std::logic_error{ "progressive genetic algorithm evaluates its "
+                              "population locally" };
+    }
+
+    // runs whole training process
+    void run() override
+    {
+      while ( step() )
+      {
+      }
+
+      print_completion_info();
+    }
+
+    // runs single generation of training process (first call evaluates
+    // initial population); returns false once stopping criteria are met
+    bool step() override
+    {
+      if ( !m_is_started )
+      {
+        evaluate_population();
+        m_is_started = true;
+        publish_state();
+      }
+      if ( check_completion_condition() )
+      {
+        return false;
+      }
+
+      update_mutation_rate();
+      breed();
+      std::swap( m_pop, m_next );
+      evaluate_population();
+      m_record_repeats = m_record_gen == m_curr_gen ? 0u
+                                                    : m_record_repeats + 1u;
+
+      // convergence triggers of stages
+      if ( !is_last_stage() )
+      {
+        if ( m_best_repeats >= m_settings.stage_stall_threshold )
+        {
+          promote_population();
+        }
+      }
+      else if ( m_record_repeats >= m_settings.pop_reset_threshold )
+      {
+        restart_schedule();
+      }
+      else if ( m_best_repeats >= m_settings.stage_stall_threshold )
+      {
+        spread_around_best();
+      }
+
+      print_progress();
+      m_curr_gen++;
+      publish_state();
+
+      return !check_completion_condition();
+    }
+
+    // puts given chromosomes into initial population in place of its last
+    // members (their coefficients are rounded to grid of first stage, but
+    // they are also candidates for result as they are)
+    void seed( population_t< N > const &seeds ) override
+    {
+      assert( !m_is_started );
+      auto count = std::min( seeds.size(), m_pop.size() );
+      for ( auto i = std::size_t{ 0 }; i < count; i++ )
+      {
+        auto poly = to_polynomial( seeds[ i ] );
+        m_pop[ m_pop.size() - 1u - i ] = encode( &poly[ 0 ] );
+        offer_record( &poly[ 0 ] );
+      }
+    }
+
+    // returns best polynomial found (in any stage) and its error
+    typename solver_t< N >::result_t result() const override
+    {
+      auto res = record_polynomial();
+      if ( m_settings.is_file_output_enabled )
+      {
+        res.to_file( std::string{ "data/" } + m_settings.batch_name +
+                     "_output_poly.tsv" );
+      }
+      return std::make_pair( res, m_record_error );
+    }
+
+    // progress queries
+    std::size_t generation() const noexcept override { return m_curr_gen; }
+    std::size_t evaluation_count() const noexcept override
+    {
+      return m_eval_count;
+    }
+    double best_error() const noexcept override { return m_record_error; }
+    double avg_error() const noexcept { return m_avg_error; }
+    bool is_done() const override
+    {
+      return m_is_started && check_completion_condition();
+    }
+
+    // index of current stage and width of its codes
+    std::size_t stage() const noexcept { return m_stage; }
+    std::size_t code_bits() const noexcept { return m_grid.bits(); }
+
+  private:
+    /*-----------------------*/
+    /*     HELPER METHODS    */
+    /*-----------------------*/
+
+    bool is_last_stage() const noexcept
+    {
+      return m_stage + 1u == m_stages.size();
+    }
+
+    // number of genes of members in current stage
+    std::size_t gene_count() const noexcept { return K * m_grid.bits(); }
+
+    // random member of current stage
+    std::uint64_t random_word() const noexcept
+    {
+      return prng_t::get_word() &
+             ( ( std::uint64_t{ 1 } << gene_count() ) - 1u );
+    }
+
+    // writes coefficients represented by given word to given buffer
+    void decode( std::uint64_t word, double *coeffs_p ) const noexcept
+    {
+      auto bits = m_grid.bits();
+      auto mask = ( std::uint64_t{ 1 } << bits ) - 1u;
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        coeffs_p[ k ] = m_grid.decode( ( word >> ( k * bits ) ) & mask );
+      }
+    }
+
+    // word of codes nearest to given coefficients in current grid
+    std::uint64_t encode( double const *coeffs_p ) const noexcept
+    {
+      auto res = std::uint64_t{ 0 };
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        res |= m_grid.encode( coeffs_p[ k ] ) << ( k * m_grid.bits() );
+      }
+      return res;
+    }
+
+    // word of codes of given coefficients shifted by random number of
+    // steps of grid (at most given number of them each way) in every
+    // coefficient
+    std::uint64_t spread( double const *coeffs_p,
+                          std::size_t max_steps ) const
+    {
+      double cs[ K ];
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        auto steps =
+          static_cast< double >( prng_t::get_index( 2u * max_steps + 1u ) ) -
+          static_cast< double >( max_steps );
+        cs[ k ] = coeffs_p[ k ] + m_grid.step() * steps;
+      }
+      return encode( cs );
+    }
+
+    polynomial_t< K - 1u > record_polynomial() const noexcept
+    {
+      auto coeffs = m_record;
+      return polynomial_t< K - 1u >{ coeffs.data() };
+    }
+
+    // checks if given stopping criteria are met (or solver is cancelled)
+    bool check_completion_condition() const
+    {
+      return m_curr_gen >= m_settings.max_gens ||
+             m_record_error <= m_settings.error_threshold ||
+             this->is_cancelled();
+    }
+
+    // publishes current state for snapshot readers
+    void publish_state() noexcept
+    {
+      auto snap = solver_snapshot_t{};
+      snap.generation = m_curr_gen;
+      snap.evaluation_count = m_eval_count;
+      snap.best_error = m_record_error;
+      snap.avg_error = m_avg_error;
+      snap.mutation_rate = m_mutation_rate;
+      snap.is_done = check_completion_condition();
+      this->publish( record_polynomial(), snap );
+    }
+
+    // finds best member and average error of population, counts
+    // generations without significant improvement of best error and keeps
+    // best solution found so far
+    void update_statistics()
+    {
+      auto sum = double{ 0.0 };
+      m_best = 0u;
+      for ( auto i = std::size_t{ 0 }; i < m_errors.size(); i++ )
+      {
+        sum += m_errors[ i ];
+        if ( m_errors[ i ] < m_errors[ m_best ] )
+        {
+          m_best = i;
+        }
+      }
+      m_avg_error = sum / static_cast< double >( m_errors.size() );
+
+      auto err_of_best = m_errors[ m_best ];
+      if ( err_of_best <
+           m_error * ( 1.0 - m_settings.small_progress_rate_threshold ) )
+      {
+        m_best_repeats = 0u;
+      }
+      else
+      {
+        m_best_repeats++;
+      }
+      m_error = err_of_best;
+
+      if ( err_of_best < m_record_error )
+      {
+        decode( m_pop[ m_best ], m_record.data() );
+        m_record_error = err_of_best;
+        m_record_gen = m_curr_gen;
+      }
+    }
+
+    // evaluates given coefficients rounded to grid of last stage and keeps
+    // them if they are better than best solution found so far - solutions
+    // known in advance are not lost by rounding to coarse grids
+    void offer_record( double const *coeffs_p )
+    {
+      auto grid = coeff_grid_t{ m_stages.back() };
+      auto cs = std::array< double, K >{};
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        cs[ k ] = grid.decode( grid.encode( coeffs_p[ k ] ) );
+      }
+      auto err = dispatch_metric(
+        m_settings.error_metric, m_settings.huber_delta,
+        [this, &cs]( auto metric ) {
+          return eval_error( cs, m_data, metric );
+        } );
+      m_eval_count++;
+      if ( err < m_record_error )
+      {
+        m_record = cs;
+        m_record_error = err;
+        m_record_gen = m_curr_gen;
+      }
+    }
+
+    /*------------------------*/
+    /*     ALGORITHM STEPS    */
+    /*------------------------*/
+
+    // fills population with random words of first stage, some of them
+    // replaced by least-squares fit and its neighbours on grid (fit itself
+    // is also candidate for result)
+    void initialize_population()
+    {
+      m_stage = 0u;
+      m_grid = coeff_grid_t{ m_stages.front() };
+      m_error = std::numeric_limits< double >::infinity();
+      m_best_repeats = 0u;
+      for ( auto &&word : m_pop )
+      {
+        word = random_word();
+      }
+
+      auto count = static_cast< std::size_t >(
+        std::ceil( m_settings.warm_start_fraction *
+                   static_cast< double >( m_pop.size() ) ) );
+      count = std::min( count, m_pop.size() );
+      auto coeffs = std::vector< double >{};
+      if ( count == 0u || !least_squares_coeffs( m_tdata, K, coeffs ) )
+      {
+        return;
+      }
+      m_pop[ 0 ] = encode( coeffs.data() );
+      offer_record( coeffs.data() );
+      for ( auto i = std::size_t{ 1 }; i < count; i++ )
+      {
+        m_pop[ i ] = spread( coeffs.data(), SPREAD_STEPS );
+      }
+    }
+
+    // computes errors of current population (metric is dispatched once for
+    // whole population)
+    void evaluate_population()
+    {
+      dispatch_metric( m_settings.error_metric, m_settings.huber_delta,
+                       [this]( auto metric ) {
+                         auto cs = std::array< double, K >{};
+                         for ( auto i = std::size_t{ 0 }; i < m_pop.size();
+                               i++ )
+                         {
+                           decode( m_pop[ i ], cs.data() );
+                           m_errors[ i ] = eval_error( cs, m_data, metric );
+                         }
+                       } );
+      m_eval_count += m_pop.size();
+      update_statistics();
+    }
+
+    // adjusts mutation rate to number of generations without improvement
+    // (as genetic algorithm does)
+    void update_mutation_rate()
+    {
+      if ( m_best_repeats < m_settings.mutation_rate_growth_threshold )
+      {
+        m_mutation_rate = m_settings.base_mutation_rate;
+      }
+      else
+      {
+        m_mutation_rate = std::min(
+          m_settings.base_mutation_rate *
+            static_cast< double >( m_best_repeats ) *
+            m_settings.mutation_rate_growth_coeff,
+          1.0 );
+      }
+    }
+
+    // creates next population - best member is kept, other ones are
+    // children of parents selected proportionally to inverse of their
+    // errors, made by single point crossover and mutation
+    void breed()
+    {
+      auto total = double{ 0.0 };
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        total += m_errors[ i ] != 0.0 ? 1.0 / m_errors[ i ] : 100000.0;
+        m_fits[ i ] = total;
+      }
+      auto pick = [this, total]() {
+        auto it = std::upper_bound( std::begin( m_fits ), std::end( m_fits ),
+                                    prng_t::get_word_fraction() * total );
+        return std::min( static_cast< std::size_t >(
+                           std::distance( std::begin( m_fits ), it ) ),
+                         m_fits.size() - 1u );
+      };
+
+      auto genes = gene_count();
+      m_next[ 0 ] = m_pop[ m_best ];
+      for ( auto i = std::size_t{ 1 }; i < m_next.size(); i++ )
+      {
+        auto point = 1u + prng_t::get_index( genes - 1u );
+        auto lows = ( std::uint64_t{ 1 } << point ) - 1u;
+        m_next[ i ] = ( m_pop[ pick() ] & lows ) | ( m_pop[ pick() ] & ~lows );
+      }
+
+      mutate( genes );
+    }
+
+    // flips genes of all members of next population except first one with
+    // probability of mutation rate - positions of flips are skip sampled
+    // (geometrically distributed gaps)
+    void mutate( std::size_t genes )
+    {
+      if ( !( m_mutation_rate > 0.0 ) )
+      {
+        return;
+      }
+      auto log_q =
+        m_mutation_rate < 1.0 ? std::log1p( -m_mutation_rate ) : 0.0;
+      auto gap = [log_q]() {
+        return log_q == 0.0
+                 ? 0.0
+                 : std::floor( std::log( 1.0 - prng_t::get_word_fraction() ) /
+                               log_q );
+      };
+
+      auto last = static_cast< double >( m_next.size() * genes );
+      for ( auto pos = static_cast< double >( genes ) + gap(); pos < last;
+            pos += 1.0 + gap() )
+      {
+        auto index = static_cast< std::size_t >( pos );
+        m_next[ index / genes ] ^= std::uint64_t{ 1 } << ( index % genes );
+      }
+    }
+
+    // moves population to grid of next stage - codes are expanded (so
+    // that best member keeps its value and error), other members are then
+    // moved by few steps of previous grid
+    void promote_population()
+    {
+      auto bits = m_grid.bits();
+      auto expanded_bits = m_stages[ m_stage + 1u ];
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
+      {
+        std::printf( "Stage %lu (%lu-bit coefficients) converged with best "
+                     "error %.3f - promoting population to %lu-bit "
+                     "coefficients.\n",
+                     m_stage + 1u, bits, m_errors[ m_best ], expanded_bits );
+      }
+
+      for ( auto &&word : m_pop )
+      {
+        word = expand_codes( word, K, bits, expanded_bits );
+      }
+      m_grid = coeff_grid_t{ expanded_bits };
+      m_stage++;
+
+      // at most one step of previous grid each way
+      auto cell_steps = std::size_t{ 1 } << ( expanded_bits - bits );
+      double cs[ K ];
+      for ( auto i = std::size_t{ 0 }; i < m_pop.size(); i++ )
+      {
+        if ( i != m_best )
+        {
+          decode( m_pop[ i ], cs );
+          m_pop[ i ] = spread( cs, cell_steps );
+        }
+      }
+      evaluate_population();
+      m_best_repeats = 0u;
+    }
+
+    // replaces all members except best one by ones spread around it
+    void spread_around_best()
+    {
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
+      {
+        std::printf( "Population stagnated for %lu generations - spreading "
+                     "it around best member.\n",
+                     m_best_repeats );
+      }
+
+      double best[ K ];
+      decode( m_pop[ m_best ], best );
+      std::swap( m_pop[ 0 ], m_pop[ m_best ] );
+      for ( auto i = std::size_t{ 1 }; i < m_pop.size(); i++ )
+      {
+        m_pop[ i ] = spread( best, SPREAD_STEPS );
+      }
+      evaluate_population();
+      m_best_repeats = 0u;
+    }
+
+    // starts all stages over with new population (best solution found so
+    // far is kept aside)
+    void restart_schedule()
+    {
+      if ( m_settings.is_verbose && !m_settings.is_quiet )
+      {
+        std::printf( "Best error did not improve for %lu generations - "
+                     "restarting from first stage.\n",
+                     m_record_repeats );
+      }
+
+      initialize_population();
+      evaluate_population();
+      m_record_repeats = 0u;
+    }
+
+    /*--------------------------*/
+    /*    INFORMATION OUTPUT    */
+    /*--------------------------*/
+
+    // writes (every print interval) progress info to stdout
+    void print_progress() const
+    {
+      if ( m_settings.is_verbose &&
+           m_curr_gen % m_settings.print_interval == 0 )
+      {
+        std::printf( "GEN# %04lu -   avg_err: %10.3f,   best_err: %10.3f,   "
+                     "bits: %2lu,   reps: %7lu;\n",
+                     m_curr_gen, m_avg_error, m_errors[ m_best ],
+                     m_grid.bits(), m_best_repeats );
+      }
+    }
+
+    // prints to stdout info about final state
+    void print_completion_info() const
+    {
+      if ( m_settings.is_quiet )
+      {
+        return;
+      }
+
+      if ( m_settings.is_verbose )
+      {
+        std::printf( "\n" );
+      }
+
+      if ( m_record_error > m_settings.error_threshold &&
+           this->is_cancelled() )
+      {
+        std::printf( "Progressive genetic algorithm cancelled after %lu "
+                     "generations (in stage %lu of %lu).\n",
+                     m_curr_gen - 1u, m_stage + 1u, m_stages.size() );
+      }
+      else if ( m_record_error > m_settings.error_threshold )
+      {
+        std::printf(
+          "Progressive genetic algorithm ended after reaching maximal number "
+          "of generations allowed without finding solution that satisfies "
+          "requested precision.\n" );
+      }
+      else
+      {
+        std::printf( "Progressive genetic algorithm ended after %lu "
+                     "generations (%lu evaluations) finding solution that "
+                     "satisfies requested precision (in stage %lu of %lu, "
+                     "%lu-bit coefficients).\n",
+                     m_curr_gen - 1u, m_eval_count, m_stage + 1u,
+                     m_stages.size(), m_grid.bits() );
+      }
+    }
+
+  private:
+    ga_settings_t m_settings;
+    training_data_t m_tdata;
+    metric_data_t m_data;
+
+    std::vector< std::size_t > m_stages;  // widths of codes
+    coeff_grid_t m_grid;                  // of current stage
+
+    std::vector< std::uint64_t > m_pop;  // packed codes (code k at k * bits)
+    std::vector< std::uint64_t > m_next;
+    std::vector< double > m_errors;
+    std::vector< double > m_fits;  // cumulative inverse errors
+
+    std::array< double, K > m_record = {};  // best solution found so far
+    double m_record_error = std::numeric_limits< double >::infinity();
+    std::size_t m_record_gen = 0u;      // generation it was found in
+    std::size_t m_record_repeats = 0u;  // generations since then
+
+    std::size_t m_curr_gen = 1u;
+    std::size_t m_stage = 0u;
+    std::size_t m_best = 0u;
+    std::size_t m_best_repeats = 0u;
+    std::size_t m_eval_count = 0u;
+
+    double m_error = std::numeric_limits< double >::infinity();
+    double m_avg_error = 0.0;
+    double m_mutation_rate;
+
+    bool m_is_started = false;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_PROGRESSIVE_H_INCLUDED
@@ -0,0 +1 @@
+#include "rates.h"
@@ -0,0 +1,184 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_RATES_H_INCLUDED
+#define ISAI_GENEPI_RATES_H_INCLUDED
+
+#include "chromo.h"
+#include "prng.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace isai
+{
+
+  // per-gene weights of mutation rate adapted online from improvement
+  // measured per gene position - every mutated child credits all genes it
+  // got flipped with its gain (e.g. 1 if it got better than its parents);
+  // weight of gene is its average credit per flip (smoothed towards average
+  // of all genes) relative to mean of all of them, so that overall number
+  // of mutations stays given by global mutation rate; statistics decay
+  // every generation, so weights follow progress of search (e.g. from high
+  // order bits early to low order ones near convergence)
+  template < std::size_t N >
+  class gene_rates_t
+  {
+  public:
+    // factor applied to statistics every generation
+    static constexpr const double DECAY = 0.9;
+
+    // number of average flips that every gene is assumed to have had
+    static constexpr const double PRIOR_FLIPS = 20.0;
+
+    // bounds of weights (relative to mean)
+    static constexpr const double MIN_WEIGHT = 0.1;
+    static constexpr const double MAX_WEIGHT = 10.0;
+
+    gene_rates_t() noexcept { reset(); }
+
+    // clears statistics (all weights equal)
+    void reset() noexcept
+    {
+      m_flips.fill( 0.0 );
+      m_gains.fill( 0.0 );
+      m_weights.fill( 1.0 );
+    }
+
+    // weight of mutation rate of given gene
+    double weight( std::size_t g ) const noexcept
+    {
+      assert( g < N );
+      return m_weights[ g ];
+    }
+
+    // fills given array with rates of genes for given global rate
+    void rates( double base_rate, std::array< double, N > &res ) const noexcept
+    {
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        res[ g ] = std::min( base_rate * m_weights[ g ], 1.0 );
+      }
+    }
+
+    // credits genes flipped in single child (bit g of given mask set if gene
+    // g was flipped) with its relative gain
+    void credit( std::uint64_t flipped, double gain ) noexcept
+    {
+      while ( flipped != 0u )
+      {
+        auto g = static_cast< std::size_t >( __builtin_ctzll( flipped ) );
+        flipped &= flipped - 1u;
+        m_flips[ g ] += 1.0;
+        m_gains[ g ] += gain;
+      }
+    }
+
+    // recomputes weights from credits collected so far and decays them
+    void update() noexcept
+    {
+      auto flip_sum = double{ 0.0 };
+      auto gain_sum = double{ 0.0 };
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        flip_sum += m_flips[ g ];
+        gain_sum += m_gains[ g ];
+      }
+      if ( !( gain_sum > 0.0 ) )
+      {
+        decay();
+        return;
+      }
+
+      auto avg_gain = gain_sum / flip_sum;
+      auto score_sum = double{ 0.0 };
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        m_weights[ g ] = ( m_gains[ g ] + PRIOR_FLIPS * avg_gain ) /
+                         ( m_flips[ g ] + PRIOR_FLIPS );
+        score_sum += m_weights[ g ];
+      }
+      auto mean = score_sum / static_cast< double >( N );
+      for ( auto &&w : m_weights )
+      {
+        w = std::min( std::max( w / mean, MIN_WEIGHT ), MAX_WEIGHT );
+      }
+      decay();
+    }
+
+  private:
+    void decay() noexcept
+    {
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        m_flips[ g ] *= DECAY;
+        m_gains[ g ] *= DECAY;
+      }
+    }
+
+  private:
+    std::array< double, N > m_flips;    // decayed counts of flips
+    std::array< double, N > m_gains;    // decayed sums of credited gains
+    std::array< double, N > m_weights;  // relative to mean (1)
+  };
+
+  // mutates members of given range of population, gene g with probability
+  // rates[ g ] - skip sampling with thinning: candidate positions (member,
+  // gene) are visited with geometrically distributed gaps for largest rate
+  // and each is accepted with ratio of its gene's rate to largest one, so
+  // work is proportional to number of mutations instead of number of
+  // genes; flipped genes of every member are stored in given masks (unless
+  // null; indexed as population)
+  template < std::size_t N >
+  void mutate_skip_sampled( population_t< N > &pop, std::size_t begin,
+                            std::size_t end,
+                            std::array< double, N > const &rates,
+                            std::uint64_t *flips_p )
+  {
+    static_assert( N < 64u, "chromosome does not fit in single word" );
+    assert( begin <= end && end <= pop.size() );
+    if ( flips_p != nullptr )
+    {
+      std::fill( flips_p + begin, flips_p + end, std::uint64_t{ 0 } );
+    }
+
+    auto top = *std::max_element( std::begin( rates ), std::end( rates ) );
+    if ( !( top > 0.0 ) )
+    {
+      return;
+    }
+
+    // gaps are 0 for rate 1 (every position is candidate)
+    auto log_q = top < 1.0 ? std::log1p( -top ) : 0.0;
+    auto gap = [log_q]() {
+      return log_q == 0.0
+               ? 0.0
+               : std::floor( std::log( 1.0 - prng_t::get_word_fraction() ) /
+                             log_q );
+    };
+
+    auto last = static_cast< double >( end * N );
+    for ( auto pos = static_cast< double >( begin * N ) + gap(); pos < last;
+          pos += 1.0 + gap() )
+    {
+      auto index = static_cast< std::size_t >( pos );
+      auto i = index / N;
+      auto g = index % N;
+      if ( rates[ g ] < top &&
+           prng_t::get_word_fraction() * top >= rates[ g ] )
+      {
+        continue;
+      }
+      pop[ i ].flip_gene( g );
+      if ( flips_p != nullptr )
+      {
+        flips_p[ i ] |= std::uint64_t{ 1 } << g;
+      }
+    }
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_RATES_H_INCLUDED
@@ -0,0 +1 @@
+#include "seqlock.h"
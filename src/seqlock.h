@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_SEQLOCK_H_INCLUDED
+#define ISAI_GENEPI_SEQLOCK_H_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace isai
+{
+
+  // value of trivially copyable type shared by single writer with any
+  // number of readers - sequence lock: writer makes sequence number odd,
+  // stores value and makes it even again, readers copy value and retry if
+  // sequence changed meanwhile; writer never waits, readers only retry while
+  // write is in progress (value is kept as atomic words, so that torn
+  // copies are harmless)
+  template < typename T >
+  class seqlock_t
+  {
+    static_assert( std::is_trivially_copyable< T >::value,
+                   "seqlock_t requires trivially copyable type" );
+
+  public:
+    // constructor - holds given value
+    explicit seqlock_t( T const &value = T{} ) noexcept { store( value ); }
+
+    // copies hold current value of given one (sequences are independent)
+    seqlock_t( seqlock_t const &other ) noexcept { store( other.load() ); }
+    seqlock_t &operator=( seqlock_t const &other ) noexcept
+    {
+      store( other.load() );
+      return *this;
+    }
+
+    // publishes given value (single writer only)
+    void store( T const &value ) noexcept
+    {
+      auto words = words_t{};
+      std::memcpy( words.data(), &value, sizeof( T ) );
+
+      auto seq = m_seq.load( std::memory_order_relaxed );
+      m_seq.store( seq + 1u, std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_release );
+      for ( auto i = std::size_t{ 0 }; i < WORD_COUNT; i++ )
+      {
+        m_words[ i ].store( words[ i ], std::memory_order_relaxed );
+      }
+      m_seq.store( seq + 2u, std::memory_order_release );
+    }
+
+    // returns consistent copy of latest published value
+    T load() const noexcept
+    {
+      auto words = words_t{};
+      for ( ;; )
+      {
+        auto seq = m_seq.load( std::memory_order_acquire );
+        if ( seq % 2u != 0u )
+        {
+          std::this_thread::yield();
+          continue;
+        }
+        for ( auto i = std::size_t{ 0 }; i < WORD_COUNT; i++ )
+        {
+          words[ i ] = m_words[ i ].load( std::memory_order_relaxed );
+        }
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if ( m_seq.load( std::memory_order_relaxed ) == seq )
+        {
+          break;
+        }
+      }
+
+      auto res = T{};
+      std::memcpy( static_cast< void * >( &res ), words.data(), sizeof( T ) );
+      return res;
+    }
+
+    // number of values published so far
+    std::uint64_t version() const noexcept
+    {
+      return m_seq.load( std::memory_order_acquire ) / 2u;
+    }
+
+  private:
+    static constexpr const std::size_t WORD_COUNT =
+      ( sizeof( T ) + sizeof( std::uint64_t ) - 1u ) / sizeof( std::uint64_t );
+
+    using words_t = std::array< std::uint64_t, WORD_COUNT >;
+
+    std::atomic< std::uint64_t > m_seq{ 0u };
+    std::array< std::atomic< std::uint64_t >, WORD_COUNT > m_words{};
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_SEQLOCK_H_INCLUDED
@@ -0,0 +1 @@
+#include "shuffle.h"
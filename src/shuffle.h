@@ -0,0 +1,117 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_SHUFFLE_H_INCLUDED
+#define ISAI_GENEPI_SHUFFLE_H_INCLUDED
+
+#include "pool.h"
+#include "prng.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace isai
+{
+
+  // generator of uniformly random permutations of (small) values, e.g.
+  // indices - bucketed scatter shuffle (rao-sandelius): every element is sent
+  // to random bucket, buckets are laid out one after another and each of them
+  // is shuffled by fisher-yates; both phases work on independent chunks or
+  // buckets, so they run in parallel if pool is given (scratch buffers are
+  // kept between calls)
+  template < typename T >
+  class scatter_shuffler_t
+  {
+  public:
+    // number of elements processed by single task of scatter phase
+    static constexpr const std::size_t CHUNK_SIZE = 4096u;
+
+    // upper limit of number of buckets (bounds size of count table)
+    static constexpr const std::size_t MAX_BUCKETS = 256u;
+
+    // randomly permutes given values
+    void shuffle( std::vector< T > &values, thread_pool_t *pool_p = nullptr )
+    {
+      auto n = values.size();
+      auto chunk_count = ( n + CHUNK_SIZE - 1u ) / CHUNK_SIZE;
+      if ( chunk_count < 2u )
+      {
+        fisher_yates( values.data(), n );
+        return;
+      }
+
+      auto bucket_count = std::min( chunk_count, MAX_BUCKETS );
+      m_buckets.resize( n );
+      m_scratch.resize( n );
+      m_offsets.assign( chunk_count * bucket_count, 0u );
+      m_starts.resize( bucket_count + 1u );
+
+      // draw bucket of every element and count elements of chunk per bucket
+      for_each_chunk(
+        pool_p, n, CHUNK_SIZE, [&]( std::size_t begin, std::size_t end ) {
+          auto counts_p =
+            m_offsets.data() + ( begin / CHUNK_SIZE ) * bucket_count;
+          for ( auto i = begin; i < end; i++ )
+          {
+            auto b = static_cast< std::uint32_t >(
+              prng_t::get_index( bucket_count ) );
+            m_buckets[ i ] = b;
+            counts_p[ b ]++;
+          }
+        } );
+
+      // turn counts into destinations (buckets first, chunks within them)
+      auto offset = std::size_t{ 0 };
+      for ( auto b = std::size_t{ 0 }; b < bucket_count; b++ )
+      {
+        m_starts[ b ] = offset;
+        for ( auto c = std::size_t{ 0 }; c < chunk_count; c++ )
+        {
+          auto count = m_offsets[ c * bucket_count + b ];
+          m_offsets[ c * bucket_count + b ] = offset;
+          offset += count;
+        }
+      }
+      m_starts[ bucket_count ] = offset;
+
+      // scatter elements into their buckets
+      for_each_chunk(
+        pool_p, n, CHUNK_SIZE, [&]( std::size_t begin, std::size_t end ) {
+          auto dest_p =
+            m_offsets.data() + ( begin / CHUNK_SIZE ) * bucket_count;
+          for ( auto i = begin; i < end; i++ )
+          {
+            m_scratch[ dest_p[ m_buckets[ i ] ]++ ] = values[ i ];
+          }
+        } );
+
+      // shuffle every bucket
+      for_each_chunk( pool_p, bucket_count, 1u,
+                      [&]( std::size_t b, std::size_t ) {
+                        fisher_yates( m_scratch.data() + m_starts[ b ],
+                                      m_starts[ b + 1u ] - m_starts[ b ] );
+                      } );
+
+      values.swap( m_scratch );
+    }
+
+  private:
+    static void fisher_yates( T *values_p, std::size_t count )
+    {
+      for ( auto i = count; i > 1u; i-- )
+      {
+        std::swap( values_p[ i - 1u ], values_p[ prng_t::get_index( i ) ] );
+      }
+    }
+
+  private:
+    std::vector< T > m_scratch;
+    std::vector< std::uint32_t > m_buckets;
+    std::vector< std::size_t > m_offsets;
+    std::vector< std::size_t > m_starts;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_SHUFFLE_H_INCLUDED
@@ -0,0 +1,73 @@
+#include "slice.h"
+
+namespace isai
+{
+
+  void transpose_bits( std::uint64_t *words_p ) noexcept
+  {
+    // swaps off-diagonal blocks of 32 x 32, then 16 x 16 within them, ...
+    auto mask = std::uint64_t{ 0x00000000ffffffffu };
+    for ( auto width = std::size_t{ 32 }; width != 0u;
+          width >>= 1u, mask ^= mask << width )
+    {
+      for ( auto i = std::size_t{ 0 }; i < SLICE_LANES;
+            i = ( ( i | width ) + 1u ) & ~width )
+      {
+        auto t = ( words_p[ i ] >> width ^ words_p[ i | width ] ) & mask;
+        words_p[ i ] ^= t << width;
+        words_p[ i | width ] ^= t;
+      }
+    }
+  }
+
+  std::uint64_t transpose_byte_bits( std::uint64_t word ) noexcept
+  {
+    auto t = ( word ^ ( word >> 7u ) ) & 0x00aa00aa00aa00aau;
+    word ^= t ^ ( t << 7u );
+    t = ( word ^ ( word >> 14u ) ) & 0x0000cccc0000ccccu;
+    word ^= t ^ ( t << 14u );
+    t = ( word ^ ( word >> 28u ) ) & 0x00000000f0f0f0f0u;
+    word ^= t ^ ( t << 28u );
+    return word;
+  }
+
+  std::uint64_t mask_threshold( double probability ) noexcept
+  {
+    if ( !( probability > 0.0 ) )
+    {
+      return 0u;
+    }
+    if ( probability >= 1.0 )
+    {
+      return std::uint64_t{ 1 } << 32u;
+    }
+    return static_cast< std::uint64_t >( probability * 4294967296.0 + 0.5 );
+  }
+
+  std::uint64_t random_mask( std::uint64_t threshold ) noexcept
+  {
+    if ( threshold >= ( std::uint64_t{ 1 } << 32u ) )
+    {
+      return ~std::uint64_t{ 0 };
+    }
+
+    // lane is set once its variable is found lesser than threshold
+    auto res = std::uint64_t{ 0 };
+    auto undecided = ~std::uint64_t{ 0 };
+    for ( auto bit = 32u; bit-- > 0u && undecided != 0u; )
+    {
+      auto word = prng_t::get_word();
+      if ( ( threshold >> bit ) & 1u )
+      {
+        res |= undecided & ~word;
+        undecided &= word;
+      }
+      else
+      {
+        undecided &= ~word;
+      }
+    }
+    return res;
+  }
+
+}  // namespace isai
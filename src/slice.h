@@ -0,0 +1,218 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_SLICE_H_INCLUDED
+#define ISAI_GENEPI_SLICE_H_INCLUDED
+
+#include "chromo.h"
+#include "prng.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace isai
+{
+
+  // number of individuals sharing single word of bit-sliced population
+  constexpr const std::size_t SLICE_LANES = 64u;
+
+  // transposes given 64 x 64 bit matrix in place (bit j of word i is
+  // exchanged with bit i of word j)
+  void transpose_bits( std::uint64_t *words_p ) noexcept;
+
+  // transposes 8 x 8 bit matrix held in given word (byte = row)
+  std::uint64_t transpose_byte_bits( std::uint64_t word ) noexcept;
+
+  // threshold of random_mask for given probability
+  std::uint64_t mask_threshold( double probability ) noexcept;
+
+  // random word with every bit set independently with probability given by
+  // threshold (in units of 2^-32) - all 64 uniform variables are compared
+  // with threshold at once, bit by bit from most significant one, until
+  // every lane is decided (about 8 random words per mask, whatever the
+  // probability)
+  std::uint64_t random_mask( std::uint64_t threshold ) noexcept;
+
+  // population of n-gene chromosomes in bit-sliced layout - blocks of 64
+  // individuals, each block holding N words (slices), word g having gene g
+  // of individual j at bit j; mutation is xor of slices with random masks,
+  // single point crossover is blend of parent slices by masks of lanes whose
+  // crossover point lies above gene, decoding extracts 7-bit codes of eight
+  // lanes at once; blocks are converted from / to chromosomes by bit matrix
+  // transposition
+  template < std::size_t N >
+  class sliced_population_t
+  {
+  public:
+    static_assert( N < 64u, "chromosome does not fit in single word" );
+
+    // number of coefficients
+    static constexpr const std::size_t K = N / 7u;
+
+    // constructor - holds given number of individuals (all genes cleared)
+    explicit sliced_population_t( std::size_t size = 0u ) { resize( size ); }
+
+    // changes number of held individuals (reuses memory)
+    void resize( std::size_t size )
+    {
+      m_size = size;
+      m_words.assign( block_count() * N, 0u );
+    }
+
+    std::size_t size() const noexcept { return m_size; }
+    std::size_t block_count() const noexcept
+    {
+      return ( m_size + SLICE_LANES - 1u ) / SLICE_LANES;
+    }
+
+    // number of individuals in given block (last one may be partial)
+    std::size_t lane_count( std::size_t b ) const noexcept
+    {
+      assert( b < block_count() );
+      return std::min( SLICE_LANES, m_size - b * SLICE_LANES );
+    }
+
+    // slices of given block
+    std::uint64_t const *block( std::size_t b ) const noexcept
+    {
+      assert( b < block_count() );
+      return m_words.data() + b * N;
+    }
+
+    // transposes chromosomes of given population into given block
+    void load( std::size_t b, population_t< N > const &pop )
+    {
+      assert( pop.size() == m_size );
+      std::uint64_t rows[ SLICE_LANES ] = {};
+      auto base = b * SLICE_LANES;
+      for ( auto j = std::size_t{ 0 }; j < lane_count( b ); j++ )
+      {
+        rows[ j ] = to_word( pop[ base + j ] );
+      }
+      transpose_bits( rows );
+      std::copy( rows, rows + N, m_words.data() + b * N );
+    }
+
+    // transposes given block back into chromosomes of given population
+    void store( std::size_t b, population_t< N > &pop ) const
+    {
+      assert( pop.size() == m_size );
+      std::uint64_t rows[ SLICE_LANES ] = {};
+      std::copy( block( b ), block( b ) + N, rows );
+      transpose_bits( rows );
+      auto base = b * SLICE_LANES;
+      for ( auto j = std::size_t{ 0 }; j < lane_count( b ); j++ )
+      {
+        pop[ base + j ] = from_word< N >( rows[ j ] );
+      }
+    }
+
+    // breeds given block from given parents - lane j gets child of
+    // parents[ ids_p[ 2 * i ] ] and parents[ ids_p[ 2 * i + 1 ] ] (i being
+    // index of lane in whole population) made by single point crossover
+    // (at uniformly random point, as chromosome_t::crossover) followed by
+    // mutation of gene g by random masks with thresholds_p[ g ]; genes
+    // flipped in every child are stored in given masks (unless null;
+    // indexed as population)
+    void breed( std::size_t b, population_t< N > const &parents,
+                std::uint32_t const *ids_p, std::uint64_t const *thresholds_p,
+                std::uint64_t *flips_p )
+    {
+      std::uint64_t fst[ SLICE_LANES ] = {};
+      std::uint64_t snd[ SLICE_LANES ] = {};
+      std::uint64_t lows[ SLICE_LANES ] = {};  // genes taken from first
+      auto base = b * SLICE_LANES;
+      auto count = lane_count( b );
+      for ( auto j = std::size_t{ 0 }; j < count; j++ )
+      {
+        fst[ j ] = to_word( parents[ ids_p[ 2u * ( base + j ) ] ] );
+        snd[ j ] = to_word( parents[ ids_p[ 2u * ( base + j ) + 1u ] ] );
+        auto point = 1u + ( ( prng_t::get_word() >> 32u ) * N >> 32u );
+        lows[ j ] = ( std::uint64_t{ 1 } << point ) - 1u;
+      }
+      transpose_bits( fst );
+      transpose_bits( snd );
+      transpose_bits( lows );
+
+      auto lanes = count == SLICE_LANES
+                     ? ~std::uint64_t{ 0 }
+                     : ( std::uint64_t{ 1 } << count ) - 1u;
+
+      // slices of first parent are replaced by mutation masks once used
+      std::fill( std::begin( fst ) + N, std::end( fst ), std::uint64_t{ 0 } );
+      auto words_p = m_words.data() + b * N;
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        auto slice = ( fst[ g ] & lows[ g ] ) | ( snd[ g ] & ~lows[ g ] );
+        fst[ g ] = thresholds_p[ g ] != 0u
+                     ? random_mask( thresholds_p[ g ] ) & lanes
+                     : 0u;
+        words_p[ g ] = ( slice ^ fst[ g ] ) & lanes;
+      }
+
+      if ( flips_p != nullptr )
+      {
+        transpose_bits( fst );
+        std::copy( fst, fst + count, flips_p + base );
+      }
+    }
+
+    // mutates given block - every gene is flipped with probability given
+    // by threshold of random masks
+    void mutate( std::size_t b, std::uint64_t threshold )
+    {
+      if ( threshold == 0u )
+      {
+        return;
+      }
+      auto count = lane_count( b );
+      auto lanes = count == SLICE_LANES
+                     ? ~std::uint64_t{ 0 }
+                     : ( std::uint64_t{ 1 } << count ) - 1u;
+      auto words_p = m_words.data() + b * N;
+      for ( auto g = std::size_t{ 0 }; g < N; g++ )
+      {
+        words_p[ g ] ^= random_mask( threshold ) & lanes;
+      }
+    }
+
+    // writes coefficients represented by lanes of given block to given
+    // buffer (lane major, K of them per lane, a_0 first) - 7-bit codes of
+    // eight lanes are gathered from slices and transposed at once, values
+    // are looked up in coefficient table
+    void decode( std::size_t b, double *coeffs_p ) const
+    {
+      auto words_p = block( b );
+      auto count = lane_count( b );
+      for ( auto k = std::size_t{ 0 }; k < K; k++ )
+      {
+        auto codes_p = words_p + k * 7u;
+        for ( auto lane = std::size_t{ 0 }; lane < count; lane += 8u )
+        {
+          // byte r holds gene r of coefficient for lanes lane .. lane + 7
+          auto bits = std::uint64_t{ 0 };
+          for ( auto r = std::size_t{ 0 }; r < 7u; r++ )
+          {
+            bits |= ( ( codes_p[ r ] >> lane ) & 0xffu ) << ( 8u * r );
+          }
+          bits = transpose_byte_bits( bits );
+
+          auto last = std::min( lane + 8u, count );
+          for ( auto j = lane; j < last; j++ )
+          {
+            coeffs_p[ j * K + k ] =
+              COEFF_TABLE[ ( bits >> ( 8u * ( j - lane ) ) ) & 0x7fu ];
+          }
+        }
+      }
+    }
+
+  private:
+    std::size_t m_size = 0u;
+    std::vector< std::uint64_t > m_words;  // block major
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_SLICE_H_INCLUDED
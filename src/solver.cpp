@@ -0,0 +1 @@
+#include "solver.h"
@@ -0,0 +1,210 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_SOLVER_H_INCLUDED
+#define ISAI_GENEPI_SOLVER_H_INCLUDED
+
+#include "diversity.h"
+#include "eval.h"
+#include "metric.h"
+#include "poly.h"
+#include "seqlock.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isai
+{
+
+  // methods of finding approximation
+  enum class solver_kind_t
+  {
+    genetic,     // genetic algorithm
+    de,          // differential evolution on coefficient grid (see de.h)
+    exact,       // branch and bound over coefficient grid (see exact.h)
+    streaming,   // genetic algorithm on memory-mapped population (stream.h)
+    progressive  // genetic algorithm on refined grids (see progressive.h)
+  };
+
+  struct ga_settings_t
+  {
+    std::string batch_name = "default";
+    std::string stream_directory = "data";  // population files (streaming)
+    std::string solution_cache_path;  // empty - no solution cache
+    std::vector< double > input_coeffs;
+    std::vector< std::size_t > precision_stages = { 3u, 5u, 7u, 9u };  // bits
+
+    std::size_t pop_size = 1000u;
+    std::size_t max_gens = 10000u;
+    std::size_t training_data_size = 50u;
+    std::size_t print_interval = 1u;
+    std::size_t mutation_rate_growth_threshold = 25u;
+    std::size_t pop_reset_threshold = 250u;
+    std::size_t diversity_sample_size = 1000u;
+    std::size_t restart_elite_count = 10u;
+    std::size_t thread_count = 1u;  // 0 - one per hardware thread
+    std::size_t coreset_size = 0u;  // 0 - evaluate on full training data
+    std::size_t exact_node_limit = 0u;  // 0 - search until proven optimal
+    std::size_t stream_chunk_size = 65536u;  // members per streamed chunk
+    std::size_t order_search_degree = 0u;  // 0 - fit single degree only
+    std::size_t stage_stall_threshold = 5u;  // generations (progressive)
+
+    double error_threshold = 0.01;
+    double base_mutation_rate = 0.001;
+    double small_progress_rate_threshold = 0.01;
+    double mutation_rate_growth_coeff = 0.5;
+    double training_data_argmin = -10.0;
+    double training_data_argmax = 10.0;
+    double diversity_collapse_threshold = 0.02;
+    double restart_reseed_fraction = 0.5;
+    double huber_delta = 1.0;
+    double warm_start_fraction = 0.1;
+    double coreset_error_bound = 0.0;  // 0 - coreset size given explicitly
+    double de_weight = 0.7;  // differential weight (scale of difference)
+    double de_crossover_rate = 0.9;
+    double cache_seed_fraction = 0.05;  // of population seeded from cache
+    double cache_match_tolerance = 0.1;  // fingerprint distance (near hits)
+
+    restart_policy_t restart_policy = restart_policy_t::partial;
+    metric_kind_t error_metric = metric_kind_t::l1;
+    solver_kind_t solver = solver_kind_t::genetic;
+
+    bool is_input_random = true;
+    bool is_error_analytic = false;  // closed-form l2 error of known input
+    bool is_result_certified = false;  // by exact solver
+    bool is_population_bit_sliced = false;  // genetic breeding layout
+    bool is_gene_rate_adaptive = false;  // per-gene mutation rates
+    bool is_verbose = false;
+    bool is_quiet = false;
+    bool is_file_output_enabled = true;
+  };
+
+  // largest number of coefficients held by solver snapshot
+  constexpr const std::size_t SNAPSHOT_MAX_COEFFS = 8u;
+
+  // state of solver published after every generation (or improvement)
+  struct solver_snapshot_t
+  {
+    double coeffs[ SNAPSHOT_MAX_COEFFS ] = {};  // of best polynomial so far
+    std::size_t coeff_count = 0u;
+    std::size_t generation = 0u;
+    std::size_t evaluation_count = 0u;
+    double best_error = std::numeric_limits< double >::infinity();
+    double avg_error = std::numeric_limits< double >::infinity();
+    double mutation_rate = 0.0;
+    bool is_done = false;
+  };
+
+  // interface of methods finding approximation of training data by
+  // polynomial with coefficients representable by n-gene chromosomes - every
+  // solver is constructed from settings and training data and then driven
+  // either step by step or by run; other threads may meanwhile poll its
+  // snapshot and cancel it
+  template < std::size_t N >
+  class solver_t
+  {
+  public:
+    // best polynomial found and its error
+    using result_t = std::pair< polynomial_t< ( N / 7u ) - 1u >, double >;
+
+    virtual ~solver_t() = default;
+
+    // settings that solver was created with
+    virtual ga_settings_t const &settings() const noexcept = 0;
+
+    // training data that approximation is computed for
+    virtual training_data_t const &training_data() const noexcept = 0;
+
+    // runs whole training process (and reports its outcome unless quiet)
+    virtual void run() = 0;
+
+    // runs single generation (or other unit of work) of training process;
+    // returns false once stopping criteria are met
+    virtual bool step() = 0;
+
+    // returns best polynomial found and its error
+    virtual result_t result() const = 0;
+
+    // replaces component used for computing errors of candidate solutions;
+    // solvers not evaluating whole populations ignore it
+    virtual void set_evaluator(
+      std::shared_ptr< fitness_evaluator_t< N > > evaluator ) = 0;
+
+    // puts given chromosomes (e.g. solutions of similar problems) into
+    // initial population in place of its last members; to be called before
+    // first step
+    virtual void seed( population_t< N > const &seeds ) = 0;
+
+    // progress queries
+    virtual std::size_t generation() const noexcept = 0;
+    virtual std::size_t evaluation_count() const noexcept = 0;
+    virtual double best_error() const noexcept = 0;
+    virtual bool is_done() const = 0;
+
+    // latest state published by solver - may be called from any thread
+    // while solver runs (never blocks it)
+    solver_snapshot_t snapshot() const noexcept { return m_snapshot.load(); }
+
+    // asks solver to stop - may be called from any thread; current
+    // generation is finished (exact search stops soon) and solver then
+    // behaves as if its stopping criteria were met
+    void cancel() noexcept
+    {
+      m_is_cancelled.store( true, std::memory_order_relaxed );
+    }
+
+    bool is_cancelled() const noexcept
+    {
+      return m_is_cancelled.load( std::memory_order_relaxed );
+    }
+
+  protected:
+    solver_t() = default;
+
+    // copies take over published state and cancellation
+    solver_t( solver_t const &other ) noexcept :
+      m_snapshot( other.m_snapshot ),
+      m_is_cancelled( other.is_cancelled() )
+    {
+    }
+    solver_t &operator=( solver_t const &other ) noexcept
+    {
+      m_snapshot = other.m_snapshot;
+      m_is_cancelled.store( other.is_cancelled(), std::memory_order_relaxed );
+      return *this;
+    }
+
+    // publishes given best polynomial with progress of given snapshot (to
+    // be called only by thread running solver)
+    void publish( polynomial_t< ( N / 7u ) - 1u > const &best,
+                  solver_snapshot_t snap ) noexcept
+    {
+      static_assert( N / 7u <= SNAPSHOT_MAX_COEFFS,
+                     "too many coefficients for snapshot" );
+      snap.coeff_count = best.size();
+      for ( auto k = std::size_t{ 0 }; k < best.size(); k++ )
+      {
+        snap.coeffs[ k ] = best[ k ];
+      }
+      m_snapshot.store( snap );
+    }
+
+    // withdraws cancellation and clears snapshot (solver is reused for new
+    // problem)
+    void reset_live_state() noexcept
+    {
+      m_is_cancelled.store( false, std::memory_order_relaxed );
+      m_snapshot.store( solver_snapshot_t{} );
+    }
+
+  private:
+    seqlock_t< solver_snapshot_t > m_snapshot;
+    std::atomic< bool > m_is_cancelled{ false };
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_SOLVER_H_INCLUDED
@@ -0,0 +1,484 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_STREAM_H_INCLUDED
+#define ISAI_GENEPI_STREAM_H_INCLUDED
+
+#include "alg.h"
+#include "chromo.h"
+#include "eval.h"
+#include "mmap.h"
+#include "poly.h"
+#include "prng.h"
+#include "solver.h"
+#include "warmstart.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace isai
+{
+
+  // genetic algorithm for populations larger than memory - population (and
+  // fitness scores) live in memory-mapped files and every generation is
+  // processed in two sequential passes over chunks of population:
+  //   1. evaluation - errors and fitness of chunk members are computed,
+  //      fitness totals of chunks are recorded
+  //   2. breeding - offspring counts are distributed between chunks in
+  //      proportion to their fitness totals (stochastic universal sampling),
+  //      then parents are selected in proportion to fitness within chunk and
+  //      its partner chunk (offset between them rotates every generation, so
+  //      that genes flow through whole population) and children are appended
+  //      to next population file
+  // only two chunks are held in memory at once; next chunk is prefetched and
+  // processed ones are released with madvise
+  template < std::size_t N >
+  class streaming_genetic_algorithm_t final : public solver_t< N >
+  {
+  public:
+    // constructor - creates population files in stream directory of given
+    // settings (see is_ready)
+    streaming_genetic_algorithm_t( ga_settings_t settings,
+                                   training_data_t tdata ) :
+      m_settings( std::move( settings ) ),
+      m_tdata( std::move( tdata ) ),
+      m_mutation_rate( m_settings.base_mutation_rate )
+    {
+      assert( !m_tdata.empty() );
+      assert( m_settings.stream_chunk_size > 0u );
+      m_chunk_size = std::min( m_settings.stream_chunk_size,
+                               m_settings.pop_size );
+      m_chunk_count =
+        ( m_settings.pop_size + m_chunk_size - 1u ) / m_chunk_size;
+
+      m_evaluator = make_local_evaluator< N >( m_settings.error_metric,
+                                               m_settings.huber_delta );
+      m_evaluator->bind( m_tdata );
+
+      auto prefix = m_settings.stream_directory + "/" +
+                    m_settings.batch_name + "_stream_";
+      m_is_ready =
+        m_pop_file.open( prefix + "pop_a.bin",
+                         m_settings.pop_size * BYTE_COUNT ) &&
+        m_next_file.open( prefix + "pop_b.bin",
+                          m_settings.pop_size * BYTE_COUNT ) &&
+        m_fits_file.open( prefix + "fits.bin",
+                          m_settings.pop_size * sizeof( float ) );
+      if ( m_is_ready )
+      {
+        initialize_population();
+      }
+    }
+
+    // checks if population files were created and mapped
+    bool is_ready() const noexcept { return m_is_ready; }
+
+    // settings of algorithm
+    ga_settings_t const &settings() const noexcept override
+    {
+      return m_settings;
+    }
+
+    // training data that population is evaluated against
+    training_data_t const &training_data() const noexcept override
+    {
+      return m_tdata;
+    }
+
+    // replaces component used for computing errors of population chunks
+    // (binds training data to it)
+    void set_evaluator(
+      std::shared_ptr< fitness_evaluator_t< N > > evaluator ) override
+    {
+      assert( evaluator );
+      evaluator->bind( m_tdata );
+      m_evaluator = std::move( evaluator );
+    }
+
+    // runs whole training process
+    void run() override
+    {
+      while ( step() )
+      {
+      }
+
+      if ( !m_settings.is_quiet )
+      {
+        std::printf( this->is_cancelled() &&
+                         m_error > m_settings.error_threshold
+                       ? "Training cancelled after %lu generations.\n"
+                       : "Training ended after %lu generations.\n",
+                     m_curr_gen - 1u );
+      }
+    }
+
+    // runs single generation of training process (first call evaluates
+    // initial population); returns false once stopping criteria are met
+    bool step() override
+    {
+      assert( m_is_ready );
+      if ( !m_is_started )
+      {
+        evaluate_population();
+        m_is_started = true;
+        publish_state();
+      }
+      if ( check_completion_condition() )
+      {
+        return false;
+      }
+
+      breed_population();
+      evaluate_population();
+      adjust_mutation_rate();
+      m_curr_gen++;
+      publish_state();
+
+      return !check_completion_condition();
+    }
+
+    // puts given chromosomes into population file in place of last members
+    // of its first chunk
+    void seed( population_t< N > const &seeds ) override
+    {
+      assert( m_is_ready && !m_is_started );
+      auto length = chunk_length( 0u );
+      auto count = std::min( seeds.size(), length );
+      for ( auto i = std::size_t{ 0 }; i < count; i++ )
+      {
+        store( m_pop_file, length - 1u - i, seeds[ i ] );
+      }
+    }
+
+    // returns polynomial represented by best population member found and
+    // its error
+    typename solver_t< N >::result_t result() const override
+    {
+      return std::make_pair( to_polynomial( m_best ), m_error );
+    }
+
+    // progress queries
+    std::size_t generation() const noexcept override { return m_curr_gen; }
+    std::size_t evaluation_count() const noexcept override
+    {
+      return m_eval_count;
+    }
+    double best_error() const noexcept override { return m_error; }
+    double avg_error() const noexcept { return m_avg_error; }
+    double mutation_rate() const noexcept { return m_mutation_rate; }
+    bool is_done() const override
+    {
+      return m_is_started && check_completion_condition();
+    }
+
+  private:
+    static constexpr const std::size_t BYTE_COUNT =
+      chromosome_t< N >::BYTE_COUNT;
+
+    /*-----------------------*/
+    /*     HELPER METHODS    */
+    /*-----------------------*/
+
+    // number of population members in given chunk
+    std::size_t chunk_length( std::size_t c ) const noexcept
+    {
+      return std::min( m_chunk_size, m_settings.pop_size - c * m_chunk_size );
+    }
+
+    // reads members of given chunk of population file
+    void load_chunk( mapped_file_t const &file, std::size_t c,
+                     population_t< N > &chunk ) const
+    {
+      auto bytes_p = file.data() + c * m_chunk_size * BYTE_COUNT;
+      chunk.clear();
+      for ( auto i = std::size_t{ 0 }; i < chunk_length( c ); i++ )
+      {
+        chunk.emplace_back( bytes_p + i * BYTE_COUNT );
+      }
+    }
+
+    // writes chromosome at given position of population file
+    static void store( mapped_file_t const &file, std::size_t index,
+                       chromosome_t< N > const &chromo )
+    {
+      std::copy( chromo.begin(), chromo.end(),
+                 file.data() + index * BYTE_COUNT );
+    }
+
+    float const *chunk_fits( std::size_t c ) const noexcept
+    {
+      return reinterpret_cast< float const * >( m_fits_file.data() ) +
+             c * m_chunk_size;
+    }
+
+    // hints kernel to read given chunk of population file ahead
+    void prefetch( mapped_file_t const &file, std::size_t c ) const
+    {
+      if ( c < m_chunk_count )
+      {
+        file.will_need( c * m_chunk_size * BYTE_COUNT,
+                        chunk_length( c ) * BYTE_COUNT );
+      }
+    }
+
+    // drops given chunk of population file (and its fitness) from memory
+    void release( mapped_file_t const &file, std::size_t c ) const
+    {
+      file.release( c * m_chunk_size * BYTE_COUNT,
+                    chunk_length( c ) * BYTE_COUNT );
+      m_fits_file.release( c * m_chunk_size * sizeof( float ),
+                           chunk_length( c ) * sizeof( float ) );
+    }
+
+    // fills population file with random chromosomes (first chunk is seeded
+    // with least-squares fit); given chromosome (if any) is kept at front
+    void initialize_population( chromosome_t< N > const *elite_p = nullptr )
+    {
+      for ( auto c = std::size_t{ 0 }; c < m_chunk_count; c++ )
+      {
+        m_chunk.resize( chunk_length( c ) );
+        for ( auto &&ch : m_chunk )
+        {
+          ch = chromosome_t< N >{};
+        }
+        if ( c == 0u )
+        {
+          seed_population( m_chunk, m_tdata, m_settings.warm_start_fraction );
+          if ( elite_p != nullptr )
+          {
+            m_chunk[ 0 ] = *elite_p;
+          }
+        }
+        for ( auto i = std::size_t{ 0 }; i < m_chunk.size(); i++ )
+        {
+          store( m_pop_file, c * m_chunk_size + i, m_chunk[ i ] );
+        }
+        release( m_pop_file, c );
+      }
+    }
+
+    // checks if given stopping criteria are met (or algorithm is
+    // cancelled)
+    bool check_completion_condition() const
+    {
+      return m_curr_gen >= m_settings.max_gens ||
+             m_error <= m_settings.error_threshold || this->is_cancelled();
+    }
+
+    // publishes current state for snapshot readers
+    void publish_state() noexcept
+    {
+      auto snap = solver_snapshot_t{};
+      snap.generation = m_curr_gen;
+      snap.evaluation_count = m_eval_count;
+      snap.best_error = m_error;
+      snap.avg_error = m_avg_error;
+      snap.mutation_rate = m_mutation_rate;
+      snap.is_done = check_completion_condition();
+      this->publish( to_polynomial( m_best ), snap );
+    }
+
+    // fills cumulative fitness table of given chunk
+    void build_cdf( std::size_t c, std::vector< double > &cdf ) const
+    {
+      auto fits_p = chunk_fits( c );
+      cdf.resize( chunk_length( c ) );
+      auto total = double{ 0.0 };
+      for ( auto i = std::size_t{ 0 }; i < cdf.size(); i++ )
+      {
+        total += static_cast< double >( fits_p[ i ] );
+        cdf[ i ] = total;
+      }
+    }
+
+    // picks index from cumulative fitness table with probability
+    // proportional to its fitness
+    static std::size_t pick( std::vector< double > const &cdf )
+    {
+      auto val = prng_t::get_fraction() * cdf.back();
+      auto it = std::upper_bound( std::begin( cdf ), std::end( cdf ), val );
+      return std::min( static_cast< std::size_t >( it - std::begin( cdf ) ),
+                       cdf.size() - 1u );
+    }
+
+    /*------------------------*/
+    /*     ALGORITHM STEPS    */
+    /*------------------------*/
+
+    // first pass - evaluates population chunk by chunk, stores fitness
+    // scores (1 / error) and their chunk totals, updates best member
+    void evaluate_population()
+    {
+      auto fits_p = reinterpret_cast< float * >( m_fits_file.data() );
+      auto best_error = std::numeric_limits< double >::infinity();
+      auto error_sum = double{ 0.0 };
+      m_chunk_totals.assign( m_chunk_count, 0.0 );
+
+      for ( auto c = std::size_t{ 0 }; c < m_chunk_count; c++ )
+      {
+        prefetch( m_pop_file, c + 1u );
+        load_chunk( m_pop_file, c, m_chunk );
+        m_evaluator->evaluate( m_chunk, m_errors );
+        m_eval_count += m_chunk.size();
+
+        for ( auto i = std::size_t{ 0 }; i < m_chunk.size(); i++ )
+        {
+          auto err = m_errors[ i ];
+          auto fit = err != 0.0 ? 1.0 / err : 100000.0;
+          fits_p[ c * m_chunk_size + i ] = static_cast< float >( fit );
+          m_chunk_totals[ c ] += fit;
+          error_sum += err;
+          if ( err < best_error )
+          {
+            best_error = err;
+            m_best = m_chunk[ i ];
+          }
+        }
+        release( m_pop_file, c );
+      }
+
+      // check if error of best member changed enough
+      if ( std::abs( best_error - m_error ) <
+           m_error * m_settings.small_progress_rate_threshold )
+      {
+        m_best_repeats++;
+      }
+      m_error = best_error;
+      m_avg_error = error_sum / static_cast< double >( m_settings.pop_size );
+    }
+
+    // second pass - breeds next population chunk by chunk (see class
+    // description) and swaps population files
+    void breed_population()
+    {
+      // offspring counts of chunks - stochastic universal sampling
+      auto total = std::accumulate( std::begin( m_chunk_totals ),
+                                    std::end( m_chunk_totals ), 0.0 );
+      auto step = total / static_cast< double >( m_settings.pop_size );
+      auto pos = prng_t::get_fraction() * step;
+      auto cumulative = double{ 0.0 };
+      auto assigned = std::size_t{ 0 };
+      m_offspring.assign( m_chunk_count, 0u );
+      for ( auto c = std::size_t{ 0 }; c < m_chunk_count; c++ )
+      {
+        cumulative += m_chunk_totals[ c ];
+        while ( pos < cumulative && assigned < m_settings.pop_size )
+        {
+          m_offspring[ c ]++;
+          assigned++;
+          pos += step;
+        }
+      }
+      m_offspring[ m_chunk_count - 1u ] += m_settings.pop_size - assigned;
+
+      auto shift =
+        m_chunk_count > 1u ? 1u + m_curr_gen % ( m_chunk_count - 1u ) : 0u;
+      auto out = std::size_t{ 0 };
+      for ( auto c = std::size_t{ 0 }; c < m_chunk_count; c++ )
+      {
+        if ( m_offspring[ c ] == 0u )
+        {
+          continue;
+        }
+
+        auto partner = ( c + shift ) % m_chunk_count;
+        prefetch( m_pop_file, c + 1u );
+        prefetch( m_pop_file, ( partner + 1u ) % m_chunk_count );
+        load_chunk( m_pop_file, c, m_chunk );
+        load_chunk( m_pop_file, partner, m_partner );
+        build_cdf( c, m_cdf );
+        build_cdf( partner, m_partner_cdf );
+
+        for ( auto k = std::size_t{ 0 }; k < m_offspring[ c ]; k++ )
+        {
+          auto &&parent = m_chunk[ pick( m_cdf ) ];
+          auto child = parent.crossover( m_partner[ pick( m_partner_cdf ) ] );
+          child.mutate( m_mutation_rate );
+          store( m_next_file, out++, child );
+          if ( out % m_chunk_size == 0u )
+          {
+            release( m_next_file, out / m_chunk_size - 1u );
+          }
+        }
+        release( m_pop_file, c );
+        release( m_pop_file, partner );
+      }
+      assert( out == m_settings.pop_size );
+
+      std::swap( m_pop_file, m_next_file );
+    }
+
+    // adjusts mutation rate based on how little progress was done (same
+    // schedule as in-memory algorithm); stalled population is regenerated
+    // keeping only best member
+    void adjust_mutation_rate()
+    {
+      if ( m_best_repeats < m_settings.mutation_rate_growth_threshold )
+      {
+        m_mutation_rate = m_settings.base_mutation_rate;
+      }
+      else if ( m_best_repeats >= m_settings.pop_reset_threshold )
+      {
+        auto elite = m_best;
+        initialize_population( &elite );
+        m_mutation_rate = m_settings.base_mutation_rate;
+        m_best_repeats = 0u;
+        evaluate_population();
+      }
+      else
+      {
+        m_mutation_rate = m_settings.base_mutation_rate *
+                          static_cast< double >( m_best_repeats ) *
+                          m_settings.mutation_rate_growth_coeff;
+      }
+
+      if ( m_mutation_rate > 1.0 )
+      {
+        m_mutation_rate = 1.0;
+      }
+    }
+
+  private:
+    ga_settings_t m_settings;
+    training_data_t m_tdata;
+    std::shared_ptr< fitness_evaluator_t< N > > m_evaluator;
+
+    std::size_t m_chunk_size = 0u;
+    std::size_t m_chunk_count = 0u;
+
+    mapped_file_t m_pop_file;
+    mapped_file_t m_next_file;
+    mapped_file_t m_fits_file;
+
+    // in-memory buffers of at most two chunks
+    population_t< N > m_chunk;
+    population_t< N > m_partner;
+    std::vector< double > m_errors;
+    std::vector< double > m_cdf;
+    std::vector< double > m_partner_cdf;
+
+    // merged statistics of chunks
+    std::vector< double > m_chunk_totals;
+    std::vector< std::size_t > m_offspring;
+
+    chromosome_t< N > m_best;
+
+    std::size_t m_curr_gen = 1u;
+    std::size_t m_best_repeats = 0u;
+    std::size_t m_eval_count = 0u;
+
+    double m_mutation_rate;
+    double m_error = std::numeric_limits< double >::infinity();
+    double m_avg_error = 0.0;
+
+    bool m_is_ready = false;
+    bool m_is_started = false;
+  };
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_STREAM_H_INCLUDED
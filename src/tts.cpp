@@ -0,0 +1,316 @@
+#include "alg.h"
+#include "bench.h"
+#include "config.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+// time-to-solution benchmark harness - runs whole genetic algorithm many
+// times with controlled seeds over fixed set of target polynomials and
+// reports how fast (generations, evaluations, wall time) it reaches error
+// threshold; optionally compares results with previously stored report
+// (data of targets is noisy and least-squares warm start is disabled, so
+// that runs measure search rather than seeding)
+//
+// usage: genepa_tts [--runs R] [--targets T] [--seed S] [--name NAME]
+//                   [--config PATH] [--baseline PATH] [--tolerance F]
+
+struct tts_options_t
+{
+  std::size_t run_count = 10u;
+  std::size_t target_count = 8u;
+  std::uint64_t base_seed = 1u;
+  std::string name = "default";
+  std::string config_path = "data/config.txt";
+  std::string baseline_path;
+  double tolerance = 0.1;
+};
+
+struct run_record_t
+{
+  std::size_t target;
+  std::size_t run;
+  std::uint64_t seed;
+  bool is_solved;
+  std::size_t generations;
+  std::size_t evaluations;
+  double wall_ms;
+  double error;
+};
+
+using report_t = std::vector< std::pair< std::string, double > >;
+
+// seed of given run for given target
+std::uint64_t run_seed( tts_options_t const &opts, std::size_t target,
+                        std::size_t run )
+{
+  return opts.base_seed * 1000003u + target * 7919u + run;
+}
+
+// runs algorithm once and measures its time to solution
+run_record_t time_run( isai::ga_settings_t const &settings,
+                       isai::polynomial_t< 4 > target_poly,
+                       std::size_t target, std::size_t run,
+                       std::uint64_t seed )
+{
+  isai::prng_t::seed( seed );
+  auto tdata = isai::bench_training_data( target_poly, settings );
+
+  auto start = std::chrono::steady_clock::now();
+  auto ga = isai::genetic_algorithm_t< 35 >{ settings, std::move( tdata ) };
+  ga.run();
+  auto wall_ms = std::chrono::duration< double, std::milli >(
+                   std::chrono::steady_clock::now() - start )
+                   .count();
+
+  return run_record_t{ target,
+                       run,
+                       seed,
+                       ga.best_error() <= settings.error_threshold,
+                       ga.generation() - 1u,
+                       ga.evaluation_count(),
+                       wall_ms,
+                       ga.best_error() };
+}
+
+// q-quantile (linearly interpolated) of given values
+double percentile( std::vector< double > values, double q )
+{
+  if ( values.empty() )
+  {
+    return 0.0;
+  }
+
+  std::sort( std::begin( values ), std::end( values ) );
+  auto pos = q * static_cast< double >( values.size() - 1u );
+  auto lo = static_cast< std::size_t >( std::floor( pos ) );
+  auto hi = std::min( lo + 1u, values.size() - 1u );
+  auto frac = pos - static_cast< double >( lo );
+  return values[ lo ] * ( 1.0 - frac ) + values[ hi ] * frac;
+}
+
+// aggregates run records into summary statistics (percentiles are computed
+// over successful runs only)
+report_t summarize( std::vector< run_record_t > const &records )
+{
+  auto gens = std::vector< double >{};
+  auto evals = std::vector< double >{};
+  auto times = std::vector< double >{};
+  auto total_ms = 0.0;
+
+  for ( auto &&r : records )
+  {
+    total_ms += r.wall_ms;
+    if ( r.is_solved )
+    {
+      gens.push_back( static_cast< double >( r.generations ) );
+      evals.push_back( static_cast< double >( r.evaluations ) );
+      times.push_back( r.wall_ms );
+    }
+  }
+
+  auto res = report_t{};
+  res.emplace_back( "runs", static_cast< double >( records.size() ) );
+  res.emplace_back( "success_rate", static_cast< double >( gens.size() ) /
+                                      static_cast< double >( records.size() ) );
+
+  auto add_percentiles = [&res]( std::string const &name,
+                                 std::vector< double > const &values ) {
+    res.emplace_back( name + "_p10", percentile( values, 0.1 ) );
+    res.emplace_back( name + "_p50", percentile( values, 0.5 ) );
+    res.emplace_back( name + "_p90", percentile( values, 0.9 ) );
+  };
+  add_percentiles( "generations", gens );
+  add_percentiles( "evaluations", evals );
+  add_percentiles( "wall_ms", times );
+  res.emplace_back( "wall_ms_mean_all",
+                    total_ms / static_cast< double >( records.size() ) );
+
+  return res;
+}
+
+// writes per-run records to file
+void records_to_file( std::string const &path,
+                      std::vector< run_record_t > const &records )
+{
+  auto fout = std::ofstream{ path, std::ios::out | std::ios::trunc };
+  fout << "target\trun\tseed\tsolved\tgenerations\tevaluations\twall_ms\t"
+          "error\n";
+  for ( auto &&r : records )
+  {
+    fout << r.target << '\t' << r.run << '\t' << r.seed << '\t'
+         << ( r.is_solved ? 1 : 0 ) << '\t' << r.generations << '\t'
+         << r.evaluations << '\t' << r.wall_ms << '\t' << r.error << '\n';
+  }
+}
+
+// writes summary as tab separated key-value lines
+void report_to_file( std::string const &path, report_t const &report )
+{
+  auto fout = std::ofstream{ path, std::ios::out | std::ios::trunc };
+  for ( auto &&kv : report )
+  {
+    fout << kv.first << '\t' << kv.second << '\n';
+  }
+}
+
+// reads summary written by report_to_file
+bool report_from_file( std::string const &path,
+                       std::map< std::string, double > &report )
+{
+  auto fin = std::ifstream{ path, std::ios::in };
+  if ( !fin )
+  {
+    return false;
+  }
+
+  auto key = std::string{};
+  auto val = double{ 0.0 };
+  while ( fin >> key >> val )
+  {
+    report[ key ] = val;
+  }
+  return true;
+}
+
+// prints comparison with baseline; returns false if any metric got worse by
+// more than given relative tolerance
+bool compare_with_baseline( report_t const &report,
+                            std::map< std::string, double > const &baseline,
+                            double tolerance )
+{
+  auto is_ok = true;
+  std::printf( "\n%-20s %14s %14s %9s\n", "metric", "baseline", "current",
+               "change" );
+  for ( auto &&kv : report )
+  {
+    auto it = baseline.find( kv.first );
+    if ( it == std::end( baseline ) || kv.first == "runs" )
+    {
+      continue;
+    }
+
+    auto base = it->second;
+    auto change = base != 0.0 ? ( kv.second - base ) / std::abs( base )
+                              : ( kv.second == 0.0 ? 0.0 : 1.0 );
+
+    // success rate is the only metric where higher is better
+    auto worse_by = kv.first == "success_rate" ? -change : change;
+    auto is_regression = worse_by > tolerance;
+    is_ok = is_ok && !is_regression;
+
+    std::printf( "%-20s %14.3f %14.3f %+8.1f%%%s\n", kv.first.c_str(), base,
+                 kv.second, 100.0 * change,
+                 is_regression ? "  REGRESSION" : "" );
+  }
+  return is_ok;
+}
+
+
+int main( int argc, char *argv[] )
+{
+  auto opts = tts_options_t{};
+
+  for ( auto i = 1; i + 1 < argc; i += 2 )
+  {
+    auto param = std::string{ argv[ i ] };
+    auto value = std::string{ argv[ i + 1 ] };
+    if ( param == "--runs" )
+    {
+      opts.run_count = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--targets" )
+    {
+      opts.target_count = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--seed" )
+    {
+      opts.base_seed = std::strtoull( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--name" )
+    {
+      opts.name = value;
+    }
+    else if ( param == "--config" )
+    {
+      opts.config_path = value;
+    }
+    else if ( param == "--baseline" )
+    {
+      opts.baseline_path = value;
+    }
+    else if ( param == "--tolerance" )
+    {
+      opts.tolerance = std::strtod( value.c_str(), nullptr );
+    }
+    else
+    {
+      std::printf( "Unknown option \"%s\" ignored.\n", param.c_str() );
+    }
+  }
+
+  auto settings = isai::ga_settings_t{};
+  if ( !isai::load_settings( opts.config_path, settings ) )
+  {
+    std::printf( "Unable to read settings from %s.\n",
+                 opts.config_path.c_str() );
+    return 1;
+  }
+  if ( opts.run_count == 0u || opts.target_count == 0u )
+  {
+    std::printf( "Nothing to run.\n" );
+    return 1;
+  }
+  settings = isai::bench_settings( settings );
+
+  std::printf( "Running %lu runs for each of %lu targets (pop: %lu, max "
+               "gens: %lu, threshold: %.4f)...\n",
+               opts.run_count, opts.target_count, settings.pop_size,
+               settings.max_gens, settings.error_threshold );
+
+  auto records = std::vector< run_record_t >{};
+  for ( auto t = std::size_t{ 0 }; t < opts.target_count; t++ )
+  {
+    auto poly = isai::bench_target( t );
+    for ( auto r = std::size_t{ 0 }; r < opts.run_count; r++ )
+    {
+      records.push_back(
+        time_run( settings, poly, t, r, run_seed( opts, t, r ) ) );
+    }
+
+    auto solved = std::count_if(
+      std::end( records ) - static_cast< std::ptrdiff_t >( opts.run_count ),
+      std::end( records ),
+      []( run_record_t const &rec ) { return rec.is_solved; } );
+    std::printf( "  target %2lu: solved %ld/%lu\n", t, solved,
+                 opts.run_count );
+  }
+
+  auto report = summarize( records );
+  records_to_file( "data/" + opts.name + "_tts_runs.tsv", records );
+  report_to_file( "data/" + opts.name + "_tts_report.tsv", report );
+
+  std::printf( "\n" );
+  for ( auto &&kv : report )
+  {
+    std::printf( "%-20s %14.3f\n", kv.first.c_str(), kv.second );
+  }
+
+  if ( !opts.baseline_path.empty() )
+  {
+    auto baseline = std::map< std::string, double >{};
+    if ( !report_from_file( opts.baseline_path, baseline ) )
+    {
+      std::printf( "Unable to read baseline from %s.\n",
+                   opts.baseline_path.c_str() );
+      return 1;
+    }
+    return compare_with_baseline( report, baseline, opts.tolerance ) ? 0 : 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,278 @@
+#include "alg.h"
+#include "bench.h"
+#include "config.h"
+#include "pool.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+// hyperparameter tuner - races randomly sampled configurations of
+// population size and mutation / restart schedule (plus configuration read
+// from config file) over fixed set of target polynomials by successive
+// halving: in every round all surviving candidates continue their runs in
+// parallel up to growing evaluation budget, are ranked by cost of runs so
+// far (evaluations to solution, unsolved runs are penalized by how far their
+// best error is from threshold) and only best 1 / eta of them survive;
+// settings of winner are written to output file
+//
+// usage: genepa_tune [--candidates C] [--targets T] [--budget B] [--eta E]
+//                    [--seed S] [--threads N] [--config PATH]
+//                    [--output PATH]
+
+struct tune_options_t
+{
+  std::size_t candidate_count = 16u;
+  std::size_t target_count = 6u;
+  std::size_t budget = 50000u;  // evaluations per run in first round
+  std::size_t eta = 2u;
+  std::size_t thread_count = 0u;  // 0 - one per hardware thread
+  std::uint64_t base_seed = 1u;
+  std::string config_path = "data/config.txt";
+  std::string output_path = "data/tuned_config.txt";
+};
+
+struct candidate_t
+{
+  isai::ga_settings_t settings;
+  std::vector< std::unique_ptr< isai::genetic_algorithm_t< 35 > > > runs;
+  std::size_t solved_count = 0u;
+  double cost = 0.0;
+};
+
+// random value from range [ lo, hi ] with uniformly distributed logarithm
+double log_uniform( double lo, double hi )
+{
+  return lo * std::pow( hi / lo, isai::prng_t::get_fraction() );
+}
+
+// random integer from range [ lo, hi ]
+std::size_t uniform_int( std::size_t lo, std::size_t hi )
+{
+  return lo + isai::prng_t::get_index( hi - lo + 1u );
+}
+
+// settings of candidate - base ones with tuned parameters sampled at random
+isai::ga_settings_t sample_settings( isai::ga_settings_t settings )
+{
+  settings.pop_size =
+    10u * static_cast< std::size_t >( log_uniform( 10.0, 500.0 ) );
+  settings.base_mutation_rate = log_uniform( 1e-4, 2e-2 );
+  settings.mutation_rate_growth_threshold = uniform_int( 5u, 100u );
+  settings.mutation_rate_growth_coeff = log_uniform( 0.1, 4.0 );
+  settings.pop_reset_threshold =
+    std::max( settings.mutation_rate_growth_threshold + 1u,
+              uniform_int( 50u, 1000u ) );
+  return settings;
+}
+
+// cost of run so far - evaluations used, scaled up for unsolved runs by
+// number of orders of magnitude its best error is above threshold
+double run_cost( isai::genetic_algorithm_t< 35 > const &ga, double threshold )
+{
+  auto evals = static_cast< double >( ga.evaluation_count() );
+  if ( ga.best_error() <= threshold )
+  {
+    return evals;
+  }
+  return evals * ( 1.0 + std::log10( ga.best_error() / threshold ) );
+}
+
+void print_candidate( std::size_t index, candidate_t const &cand,
+                      std::size_t target_count )
+{
+  auto &&s = cand.settings;
+  std::printf( "  #%-3lu pop: %5lu  mut: %8.5f  growth thr: %3lu  growth "
+               "coeff: %6.3f  reset thr: %4lu  solved: %lu/%lu  cost: "
+               "%.4g\n",
+               index, s.pop_size, s.base_mutation_rate,
+               s.mutation_rate_growth_threshold, s.mutation_rate_growth_coeff,
+               s.pop_reset_threshold, cand.solved_count, target_count,
+               cand.cost );
+}
+
+
+int main( int argc, char *argv[] )
+{
+  auto opts = tune_options_t{};
+
+  for ( auto i = 1; i + 1 < argc; i += 2 )
+  {
+    auto param = std::string{ argv[ i ] };
+    auto value = std::string{ argv[ i + 1 ] };
+    if ( param == "--candidates" )
+    {
+      opts.candidate_count = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--targets" )
+    {
+      opts.target_count = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--budget" )
+    {
+      opts.budget = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--eta" )
+    {
+      opts.eta = std::max( 2ul, std::strtoul( value.c_str(), nullptr, 10 ) );
+    }
+    else if ( param == "--seed" )
+    {
+      opts.base_seed = std::strtoull( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--threads" )
+    {
+      opts.thread_count = std::strtoul( value.c_str(), nullptr, 10 );
+    }
+    else if ( param == "--config" )
+    {
+      opts.config_path = value;
+    }
+    else if ( param == "--output" )
+    {
+      opts.output_path = value;
+    }
+    else
+    {
+      std::printf( "Unknown option \"%s\" ignored.\n", param.c_str() );
+    }
+  }
+
+  auto base = isai::ga_settings_t{};
+  if ( !isai::load_settings( opts.config_path, base ) )
+  {
+    std::printf( "Unable to read settings from %s.\n",
+                 opts.config_path.c_str() );
+    return 1;
+  }
+  if ( opts.candidate_count == 0u || opts.target_count == 0u ||
+       opts.budget == 0u )
+  {
+    std::printf( "Nothing to tune.\n" );
+    return 1;
+  }
+
+  // runs are parallelized, not their generations; warm start and solution
+  // cache would solve noiseless targets at once and favour the smallest
+  // population, so candidates race on noisy targets without them
+  auto run_settings = isai::bench_settings( base );
+  run_settings.thread_count = 1u;
+
+  auto tdatas = std::vector< isai::training_data_t >{};
+  for ( auto t = std::size_t{ 0 }; t < opts.target_count; t++ )
+  {
+    auto poly = isai::bench_target( t );
+    isai::prng_t::seed( opts.base_seed * 1000003u + t * 7919u );
+    tdatas.push_back( isai::bench_training_data( poly, base ) );
+  }
+
+  isai::prng_t::seed( opts.base_seed );
+  auto cands = std::vector< candidate_t >( opts.candidate_count );
+  for ( auto c = std::size_t{ 0 }; c < cands.size(); c++ )
+  {
+    cands[ c ].settings =
+      c == 0u ? run_settings : sample_settings( run_settings );
+    cands[ c ].runs.resize( opts.target_count );
+  }
+
+  // calling thread works too, so thread count of 1 means no pool
+  auto thread_count = opts.thread_count != 0u
+                        ? opts.thread_count
+                        : std::max( 1u, std::thread::hardware_concurrency() );
+  auto pool = thread_count > 1u
+                ? std::make_unique< isai::thread_pool_t >( thread_count - 1u )
+                : nullptr;
+  std::printf( "Racing %lu candidates over %lu targets (threshold: %.4f, "
+               "%lu threads)...\n",
+               cands.size(), opts.target_count, base.error_threshold,
+               thread_count );
+
+  auto alive = std::vector< std::size_t >( cands.size() );
+  std::iota( std::begin( alive ), std::end( alive ), std::size_t{ 0 } );
+  auto budget = opts.budget;
+  for ( auto round = std::size_t{ 0 };; round++ )
+  {
+    // every run continues from where it stopped in previous round; random
+    // engine is reseeded per target and round, so that all candidates face
+    // the same random numbers
+    isai::for_each_chunk(
+      pool.get(), alive.size() * opts.target_count, 1u,
+      [&]( std::size_t i, std::size_t ) {
+        auto &cand = cands[ alive[ i / opts.target_count ] ];
+        auto t = i % opts.target_count;
+        isai::prng_t::seed( ( opts.base_seed * 1000003u + t * 7919u ) *
+                              31u +
+                            round );
+        auto &ga = cand.runs[ t ];
+        if ( !ga )
+        {
+          ga = std::make_unique< isai::genetic_algorithm_t< 35 > >(
+            cand.settings, tdatas[ t ] );
+        }
+        while ( ga->evaluation_count() < budget && ga->step() )
+        {
+        }
+      } );
+
+    for ( auto c : alive )
+    {
+      auto &cand = cands[ c ];
+      cand.solved_count = 0u;
+      cand.cost = 0.0;
+      for ( auto &&ga : cand.runs )
+      {
+        cand.solved_count += ga->best_error() <= base.error_threshold;
+        cand.cost += run_cost( *ga, base.error_threshold );
+      }
+    }
+    std::stable_sort( std::begin( alive ), std::end( alive ),
+                      [&cands]( std::size_t lhs, std::size_t rhs ) {
+                        return cands[ lhs ].cost < cands[ rhs ].cost;
+                      } );
+
+    std::printf( "\nRound %lu (budget: %lu evaluations per run):\n",
+                 round + 1u, budget );
+    for ( auto c : alive )
+    {
+      print_candidate( c, cands[ c ], opts.target_count );
+    }
+
+    if ( alive.size() == 1u )
+    {
+      break;
+    }
+    alive.resize( std::max( std::size_t{ 1 }, alive.size() / opts.eta ) );
+    budget *= opts.eta;
+
+    // losers' runs are no longer needed
+    for ( auto c = std::size_t{ 0 }; c < cands.size(); c++ )
+    {
+      if ( std::find( std::begin( alive ), std::end( alive ), c ) ==
+           std::end( alive ) )
+      {
+        cands[ c ].runs.clear();
+      }
+    }
+  }
+
+  // winner keeps all other settings from config file
+  auto winner = base;
+  auto &&best = cands[ alive.front() ].settings;
+  winner.pop_size = best.pop_size;
+  winner.base_mutation_rate = best.base_mutation_rate;
+  winner.mutation_rate_growth_threshold = best.mutation_rate_growth_threshold;
+  winner.mutation_rate_growth_coeff = best.mutation_rate_growth_coeff;
+  winner.pop_reset_threshold = best.pop_reset_threshold;
+  if ( !isai::save_settings( opts.output_path, winner ) )
+  {
+    std::printf( "Unable to write settings to %s.\n",
+                 opts.output_path.c_str() );
+    return 1;
+  }
+  std::printf( "\nSettings of candidate #%lu written to %s.\n", alive.front(),
+               opts.output_path.c_str() );
+  return 0;
+}
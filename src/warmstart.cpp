@@ -0,0 +1 @@
+#include "warmstart.h"
@@ -0,0 +1,151 @@
+#pragma once
+
+#ifndef ISAI_GENEPI_WARMSTART_H_INCLUDED
+#define ISAI_GENEPI_WARMSTART_H_INCLUDED
+
+#include "chromo.h"
+#include "poly.h"
+#include "prng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace isai
+{
+
+  // computes coefficients (a_0 first) of polynomial with given number of
+  // coefficients that fits given training data in weighted least squares
+  // sense; solves normal equations of vandermonde matrix built for arguments
+  // scaled to [ -1, 1 ] (keeps system well conditioned for wide argument
+  // ranges); returns false if system is singular (e.g. too few distinct
+  // arguments)
+  inline bool least_squares_coeffs( training_data_t const &td,
+                                    std::size_t coeff_count,
+                                    std::vector< double > &coeffs )
+  {
+    auto scale = double{ 0.0 };
+    for ( auto &&dp : td )
+    {
+      scale = std::max( scale, std::abs( dp.x ) );
+    }
+    if ( scale == 0.0 )
+    {
+      scale = 1.0;
+    }
+
+    // augmented normal equations matrix: [ V^T W V | V^T W y ]
+    auto cols = coeff_count + 1u;
+    auto mat = std::vector< double >( coeff_count * cols, 0.0 );
+    auto powers = std::vector< double >( coeff_count );
+    for ( auto &&dp : td )
+    {
+      auto t = dp.x / scale;
+      powers[ 0 ] = 1.0;
+      for ( auto k = std::size_t{ 1 }; k < coeff_count; k++ )
+      {
+        powers[ k ] = powers[ k - 1u ] * t;
+      }
+      for ( auto r = std::size_t{ 0 }; r < coeff_count; r++ )
+      {
+        for ( auto c = std::size_t{ 0 }; c < coeff_count; c++ )
+        {
+          mat[ r * cols + c ] += dp.w * powers[ r ] * powers[ c ];
+        }
+        mat[ r * cols + coeff_count ] += dp.w * powers[ r ] * dp.y;
+      }
+    }
+
+    // gaussian elimination with partial pivoting (pivots are compared with
+    // total weight of data)
+    auto tiny = 1e-12 * mat[ 0 ];
+    for ( auto p = std::size_t{ 0 }; p < coeff_count; p++ )
+    {
+      auto best = p;
+      for ( auto r = p + 1u; r < coeff_count; r++ )
+      {
+        if ( std::abs( mat[ r * cols + p ] ) >
+             std::abs( mat[ best * cols + p ] ) )
+        {
+          best = r;
+        }
+      }
+      if ( !( std::abs( mat[ best * cols + p ] ) > tiny ) )
+      {
+        return false;
+      }
+      for ( auto c = std::size_t{ 0 }; c < cols; c++ )
+      {
+        std::swap( mat[ p * cols + c ], mat[ best * cols + c ] );
+      }
+
+      for ( auto r = p + 1u; r < coeff_count; r++ )
+      {
+        auto f = mat[ r * cols + p ] / mat[ p * cols + p ];
+        for ( auto c = p; c < cols; c++ )
+        {
+          mat[ r * cols + c ] -= f * mat[ p * cols + c ];
+        }
+      }
+    }
+
+    coeffs.assign( coeff_count, 0.0 );
+    for ( auto p = coeff_count; p-- > 0; )
+    {
+      auto val = mat[ p * cols + coeff_count ];
+      for ( auto c = p + 1u; c < coeff_count; c++ )
+      {
+        val -= mat[ p * cols + c ] * coeffs[ c ];
+      }
+      coeffs[ p ] = val / mat[ p * cols + p ];
+    }
+
+    // undo argument scaling: a_k = b_k / scale^k
+    auto factor = double{ 1.0 };
+    for ( auto &&c : coeffs )
+    {
+      c /= factor;
+      factor *= scale;
+    }
+    return true;
+  }
+
+  // replaces given fraction of population (its first members) with
+  // least-squares fit of given training data rounded to chromosome grid and
+  // its perturbed neighbours (each coefficient shifted by up to two grid
+  // steps); returns false (leaving population untouched) if fit cannot be
+  // computed
+  template < std::size_t N >
+  bool seed_population( population_t< N > &pop, training_data_t const &td,
+                        double fraction )
+  {
+    auto count = static_cast< std::size_t >(
+      std::ceil( fraction * static_cast< double >( pop.size() ) ) );
+    count = std::min( count, pop.size() );
+
+    auto coeffs = std::vector< double >{};
+    if ( count == 0u || !least_squares_coeffs( td, N / 7u, coeffs ) )
+    {
+      return false;
+    }
+    normalize_coeffs( coeffs );
+    pop[ 0 ] = from_coeffs< N >( coeffs );
+
+    auto neighbour = std::vector< double >( coeffs.size() );
+    for ( auto i = std::size_t{ 1 }; i < count; i++ )
+    {
+      for ( auto k = std::size_t{ 0 }; k < coeffs.size(); k++ )
+      {
+        auto steps = static_cast< double >( prng_t::get_index( 5u ) ) - 2.0;
+        neighbour[ k ] = coeffs[ k ] + 0.25 * steps;
+      }
+      normalize_coeffs( neighbour );
+      pop[ i ] = from_coeffs< N >( neighbour );
+    }
+    return true;
+  }
+
+}  // namespace isai
+
+#endif  // !ISAI_GENEPI_WARMSTART_H_INCLUDED